@@ -2,24 +2,24 @@
 // LED real-time display. Designed for an Arduino Uno.
 
 // IR remote controls:
-// While the map is in operation, specific IR controls are non-functional
-// (due to how updating the LEDs disrupts IR receiver timing). By pressing any
-// remote button twice in 1000 ms, "IR mode" is enabled and the display is
-// paused. To cancel, pressing the "FUNC/STOP" button exits out of "IR mode".
-// In IR mode:
-// - FUNC/STOP -> Exits IR mode.
+// Updating the LEDs disrupts IR receiver timing, so frames are held back
+// while a remote signal is being received (see scheduler.h). All controls
+// work while the map is in operation. Pressing "FUNC/STOP" enters "IR mode",
+// where the display is paused and shows a static preview of each mode.
+// - FUNC/STOP -> Enters/exits IR mode.
 // - POWER     -> Shuts off display and enters "sleep mode". Press POWER again to wake.
 // - 0         -> Mode 0. Fading red.
 // - 1         -> Mode 1. Press again to cycle through submodes. Static rendering (white, coloured).
 // - 2         -> Mode 2. Press again to cycle through submodes. Colour test.
-// - 3         -> Mode 3. Random line diagram.
+// - 3         -> Mode 3. Press again to cycle through submodes. Line diagram (random route, train service).
 // - 4         -> Mode 4. User-set line diagram.
 // - 5         -> Mode 5. Custom set colour.
+// - 6         -> Mode 6. Frames streamed over Serial (see stream.h).
 // While in Mode 4:
 // - ST/REPT   -> Begin editing/exit editing.
 // While in Mode 4, editing mode:
-// - FFWD      -> Move endpoint by +1.
-// - REWIND    -> Move endpoint by -1.
+// - FFWD      -> Move endpoint by +1. Hold to keep moving, faster over time.
+// - REWIND    -> Move endpoint by -1. Hold to keep moving, faster over time.
 // - EQ        -> Swap the two slot positions.
 // While in Mode 5:
 // - ST/REPT   -> Begin editing/exit editing.
@@ -27,106 +27,134 @@
 // While in Mode 5, editing mode:
 // - num key   -> Add a digit for the current value.
 // - PAUSE     -> Load saved value from EEPROM.
+// Editing doesn't stop the frame loop: keys are queued as they are decoded
+// (see input.h) and the editor is redrawn at most once per frame.
 
 #include <EEPROM.h>
 #include <Adafruit_NeoPixel.h>
 #include <Entropy.h>
 #include <IRremote.h>
 #include "ir_codes.h"
+#include "input.h"
 #include "stations.h"
 #include "utils.h"
 #include "modes.h"
 #include "diagram.h"
+#include "scheduler.h"
+#include "profile.h"
+#include "animations.h"
+#include "stream.h"
 
 #define IR_RECEIVER_PIN 3
 IRrecv irrecv(IR_RECEIVER_PIN);
 decode_results irresults;
+InputQueue input;
 
 #define LED_PIN 6
 Adafruit_NeoPixel strip(NUM_STATIONS, LED_PIN, NEO_GRB + NEO_KHZ800);
+// More displays can be driven from the same render, each on its own pin or
+// chained after the first (make the strip NUM_STATIONS LEDs longer per
+// display and add it at an offset). Their strips must also be NEO_GRB. See
+// LineDiagram::addOutput.
+//#define LED_PIN_2 7
+//Adafruit_NeoPixel strip2(NUM_STATIONS, LED_PIN_2, NEO_GRB + NEO_KHZ800);
 
-#define FRAME_DELAY 20
+#define FRAME_DELAY 20 // ms, 50 fps
+// Dithered frames are sent again this often between frames. Sending takes
+// ~1.2 ms, so this leaves most of the time for rendering. With more displays
+// each refresh takes longer, and they are this much further apart per
+// display.
+#define REFRESH_DELAY 4 // ms, 250 Hz
+// Changing modes crossfades into the new one over 2^MODE_FADE_BITS ms
+#define MODE_FADE_BITS 9 // 512 ms
 
 LineDiagram diagram(&strip);
+FrameScheduler scheduler(&diagram, &irrecv, FRAME_DELAY * 1000UL, REFRESH_DELAY * 1000UL);
 
 struct {
-  uint8_t clicks = 0;
-  uint8_t clickTimer = 0;
-  unsigned long timeSinceFirstClick = 0;
+  bool enabled = false;
 } IRMode;
 
+struct {
+  bool asleep = false;
+} Sleep;
+
 struct {
   uint8_t currentMode = 1;
+  // Something else was shown since the mode was last rendered
+  bool interrupted = false;
 } Rendering;
 
+// The mode whose settings are being edited with the remote (Mode 4 or 5),
+// which takes every key until editing ends.
+#define EDITOR_NONE 0xFF
+struct {
+  uint8_t mode = EDITOR_NONE;
+  // The settings changed since the editor was last drawn
+  bool changed = false;
+  // Mode 5: the value being typed, and the colour to go back to
+  uint16_t rawValue = 0;
+  uint8_t oldRed;
+  uint8_t oldGreen;
+  uint8_t oldBlue;
+} Editor;
+
 // Call to update the LEDs based on the current mode.
 void renderWithMode() {
-  switch(Rendering.currentMode) {
-    case 0:
-      mode0_render(&diagram);
-      break;
-    case 1:
-      mode1_render(&diagram);
-      break;
-    case 2:
-      mode2_render(&diagram);
-      break;
-    case 3:
-      mode3_render(&diagram);
-      break;
-    case 4:
-      mode4_render(&diagram);
-      break;
-    case 5:
-      mode5_render(&diagram);
-      break;
-    default:
-      digitalWrite(LED_BUILTIN, LOW);
-      delay(50);
-      digitalWrite(LED_BUILTIN, HIGH);
-      return;
+  if (Rendering.currentMode >= NUM_RENDER_MODES) {
+    digitalWrite(LED_BUILTIN, LOW);
+    delay(50);
+    digitalWrite(LED_BUILTIN, HIGH);
+    return;
+  }
+  if (Rendering.interrupted) {
+    Rendering.interrupted = false;
+    mode_resume(Rendering.currentMode);
+  }
+  {
+    PROFILE_SCOPE(PROBE_MODE_0 + Rendering.currentMode);
+    mode_render(Rendering.currentMode, &diagram);
   }
-  strip.show();
+  scheduler.show();
 }
 
 // Call to update the LEDs in a NON-ANIMATING way, which should be uniquely representive of each mode.
 // For some modes which are already static, their default render function may be called instead.
-// This function clears the strip first.
+// This function clears the diagram first.
 void renderStaticWithMode() {
-  strip.clear();
-  bool didDefault = false;
-  switch(Rendering.currentMode) {
-    case 0:
-      mode0_renderStatic(&diagram);
-      break;
-    case 2:
-      mode2_renderStatic(&diagram);
-      break;
-    case 3:
-      mode3_renderStatic(&diagram);
-      break;
-    case 4:
-      mode4_renderStatic(&diagram);
-      break;
-    case 5:
-      mode5_renderStatic(&diagram);
-      break;
-    default:
-      renderWithMode();
-      didDefault = true;
-      break;
-  }
-  if (!didDefault) strip.show();
+  diagram.clear();
+  mode_renderStatic(Rendering.currentMode, &diagram);
+  scheduler.show();
+}
+
+// Switches to another mode, which starts from scratch.
+void setMode(uint8_t mode) {
+  if (mode == Rendering.currentMode) return;
+  Rendering.currentMode = mode;
+  mode_enter(mode);
 }
 
+unsigned long idleTime();
+void pollRemote();
+void handleInput(const InputEvent *event);
 void handleIRMode(unsigned long value);
+void handleSerial();
+void handleSerialCommand(uint8_t command);
+void streamFrames();
 void animate(uint8_t id);
+bool editing();
+void renderEditor();
+void mode4_startEdit();
+void mode5_startEdit();
+void mode4_editKey(const InputEvent *event);
+void mode5_editKey(const InputEvent *event);
 
 void setup() {
-  Serial.begin(9600);
+  Serial.begin(STREAM_BAUD);
   Serial.println("Initializing...");
   Entropy.initialize();
   irrecv.enableIRIn();
+  scheduler.begin(IR_RECEIVER_PIN);
 
   pinMode(LED_BUILTIN, OUTPUT);
   digitalWrite(LED_BUILTIN, HIGH);
@@ -140,17 +168,16 @@ void setup() {
 //  delay(900); noTone(5);
 
   strip.begin();            // INITIALIZE strip object (REQUIRED)
-  strip.show();             // Turn OFF all pixels
-  strip.setBrightness(70); // Set BRIGHTNESS (max = 255)
+//  strip2.begin();
+//  diagram.addOutput(&strip2, 0, NULL, 128);
+  diagram.show();           // Turn OFF all pixels
+  diagram.setBrightness(70); // Set BRIGHTNESS (max = 255)
   randomSeed(Entropy.random());
 
-  for (int i = 0; i < MODE2_PATTERN; i++)
-    mode2.pattern[i] = i;
-  mode2_shuffle();
-  pathfind(&mode4.route, mode4.start, mode4.end);
-  mode5.red = EEPROM.read(0x0);
-  mode5.green = EEPROM.read(0x1);
-  mode5.blue = EEPROM.read(0x2);
+  modeSettings.mode5Red = EEPROM.read(0x0);
+  modeSettings.mode5Green = EEPROM.read(0x1);
+  modeSettings.mode5Blue = EEPROM.read(0x2);
+  mode_enter(Rendering.currentMode);
 
 //  StationPath result;
 //  Serial.println(F("\nStation pathfind ordered test:"));
@@ -158,310 +185,406 @@ void setup() {
 //  pathfind(&result, STN_BROADWAY, STN_22ND_STREET);
 //  
 //  for (int i = 0; i < result.size; i++) {
-//    Serial.print(STN_NAMES[result.path[i]]);
+//    Serial.print(stationName(result.path[i]));
 //    Serial.print(F(", \n  "));
 //  }
 //  Serial.print(F("Done. Size: "));
 //  Serial.println(result.size);
 }
 
+// True while Mode 6 is showing streamed frames.
+bool streaming() {
+  return Rendering.currentMode == MODE_STREAM && !IRMode.enabled && !Sleep.asleep && !animation_playing();
+}
+
 void loop() {
-  if (IRMode.clicks < 2) {
-    renderWithMode();
-    delay(FRAME_DELAY); // 50 fps
-    if (irrecv.decode(&irresults)) {
-      if (IRMode.clickTimer == 0) {
-        IRMode.clickTimer = 10;
-        if (IRMode.clicks == 0) { // First click
-          IRMode.clicks = 1;
-          IRMode.timeSinceFirstClick = millis();
-        } else {
-          if (millis() - IRMode.timeSinceFirstClick < 1000) {
-            // Switch to IR mode
-            IRMode.clicks = 2;
-            animate(1);
-            renderStaticWithMode();
-          } else { // Timed out for 2 clicks, reset to 1 click
-            IRMode.clicks = 1;
-            IRMode.timeSinceFirstClick = millis();
-          }
-        }
+  bool stream = streaming();
+  // The host can send at any time, even between packets, and a refresh
+  // would lose what arrives while it is sent (see stream.h). Streamed frames
+  // are only dithered as each one is shown.
+  scheduler.setRefreshing(!stream);
+  if (stream) {
+    // The host paces the frames, so Serial is read continuously instead of
+    // waiting for the next frame (the receive buffer is smaller than a frame).
+    streamFrames();
+    // Not while a packet is partly received, so a lost byte times out
+    if (Serial.available() == 0 && !stream_receiving(&modeState.mode6.decoder)) scheduler.idle(SCHEDULER_IDLE_MAX);
+  } else {
+    scheduler.waitForFrame();
+    if (animation_playing() || editing() || IRMode.enabled || Sleep.asleep) Rendering.interrupted = true;
+    if (animation_playing()) {
+      bool playing = animation_render(&diagram);
+      scheduler.show();
+      if (!playing && !Sleep.asleep) {
+        if (editing()) Editor.changed = true;
+        else if (IRMode.enabled) renderStaticWithMode();
       }
-      irrecv.resume();
+    } else if (editing()) {
+      renderEditor();
+    } else if (!IRMode.enabled && !Sleep.asleep) {
+      renderWithMode();
     } else {
-      if (IRMode.clickTimer > 0) IRMode.clickTimer--;
+      // Nothing to render, but a crossfade carries on
+      scheduler.show();
     }
-  } else {
-    delay(FRAME_DELAY);
-    if (irrecv.decode(&irresults)) {
-      handleIRMode(irresults.value);
-      irrecv.resume();
+    scheduler.frameDone();
+    handleSerial();
+    scheduler.idle(idleTime());
+  }
+  scheduler.update();
+  pollRemote();
+  InputEvent event;
+  while (input_pop(&input, &event)) handleInput(&event);
+}
+
+// Queues the command from the remote, if one has been decoded.
+void pollRemote() {
+  if (!irrecv.decode(&irresults)) return;
+  scheduler.commandDecoded();
+  input_push(&input, irresults.value, millis());
+  irrecv.resume();
+}
+
+void handleInput(const InputEvent *event) {
+  if (editing()) {
+    if (Editor.mode == 4) mode4_editKey(event);
+    else mode5_editKey(event);
+  } else if (event->repeats == 0) {
+    handleIRMode(event->key);
+  }
+}
+
+// How long the display will stay as it is after this frame, in ms.
+unsigned long idleTime() {
+  if (animation_playing() || diagram.fading() || Rendering.currentMode >= NUM_RENDER_MODES) return 0;
+  if (IRMode.enabled || Sleep.asleep || editing()) return SCHEDULER_IDLE_MAX;
+  unsigned long wake;
+  if (!mode_wake(Rendering.currentMode, &wake)) return SCHEDULER_IDLE_MAX;
+  long left = (long) (wake - millis());
+  return left > 0 ? left : 0;
+}
+
+// Decodes streamed frames from Serial and shows each as soon as it is
+// complete. Other bytes are handled as commands.
+void streamFrames() {
+  StreamDecoder *decoder = &modeState.mode6.decoder;
+  while (Serial.available() > 0) {
+    uint8_t value = Serial.read();
+    uint8_t result = stream_read(decoder, &diagram, value);
+    if (result == STREAM_COMMAND) {
+      handleSerialCommand(value);
+    } else if (result == STREAM_FRAME) {
+      scheduler.show();
+      break;
+    }
+  }
+  stream_update(decoder, &diagram);
+}
+
+void handleSerial() {
+  if (Serial.available() == 0) return;
+  handleSerialCommand(Serial.read());
+}
+
+// Serial commands, one character each:
+// - i -> Print IR input latency, dropped frame and dropped key counts.
+// - f -> Print frame timing and idle time since the last 'f' (times in us,
+//        idle time in ms).
+// - s -> Print streamed frame counts (Mode 6).
+// - p -> Print render profiling since the last 'p' (needs MKIII_PROFILE).
+void handleSerialCommand(uint8_t command) {
+  switch (command) {
+#ifdef MKIII_PROFILE
+    case 'p':
+      profilePrint();
+      break;
+#endif
+    case 'f': {
+      FrameStats *stats = &scheduler.frameStats;
+      Serial.print(F("Frames: "));
+      Serial.print(stats->frames);
+      Serial.print(F(", time min/avg/max: "));
+      Serial.print(stats->frames == 0 ? 0 : stats->minTime);
+      Serial.print('/');
+      Serial.print(stats->frames == 0 ? 0 : stats->totalTime / stats->frames);
+      Serial.print('/');
+      Serial.print(stats->maxTime);
+      Serial.print(F(", max late: "));
+      Serial.print(stats->maxLateness);
+      Serial.print(F(", overruns: "));
+      Serial.print(stats->overruns);
+      Serial.print(F(", skipped: "));
+      Serial.print(stats->skippedFrames);
+      Serial.print(F(", refreshes: "));
+      Serial.print(stats->refreshes);
+      Serial.print(F(", idle: "));
+      Serial.print(stats->idleTime);
+      Serial.print(F(", wakes: "));
+      Serial.print(stats->wakes);
+      Serial.print(F(", max wake latency: "));
+      Serial.println(stats->maxWakeLatency);
+      *stats = FrameStats();
+      break;
     }
+    case 'i':
+      Serial.print(F("IR commands: "));
+      Serial.print(scheduler.stats.commands);
+      Serial.print(F(", latency last/max (us): "));
+      Serial.print(scheduler.stats.lastLatency);
+      Serial.print('/');
+      Serial.print(scheduler.stats.maxLatency);
+      Serial.print(F(", dropped frames: "));
+      Serial.print(scheduler.stats.droppedFrames);
+      Serial.print(F(", dropped keys: "));
+      Serial.println(input.overflows);
+      break;
+    case 's':
+      Serial.print(F("Streamed frames shown: "));
+      Serial.print(streamStats.shown);
+      Serial.print(F(", bad: "));
+      Serial.print(streamStats.bad);
+      Serial.print(F(", busy: "));
+      Serial.println(streamStats.busy);
+      break;
   }
 }
 
-void mode4_editMode();
+// Shows the new mode after it was changed by the remote, crossfading from
+// the old one. Outside of IR mode the next frame will render it instead, and
+// if an animation is playing it will be shown when the animation finishes.
+// Streamed frames are shown as they come, so Mode 6 is cut to.
+void showModeChange() {
+  if (animation_playing()) return;
+  if (Rendering.currentMode != MODE_STREAM || IRMode.enabled) diagram.crossfade(MODE_FADE_BITS);
+  if (IRMode.enabled) renderStaticWithMode();
+}
 
 void handleIRMode(unsigned long value) {
-  switch (irresults.value) {
-    case KEY_FUNC_STOP: // Exit IR mode
-      IRMode.clicks = 0;
-      animate(2);
+  if (Sleep.asleep) {
+    if (value == KEY_POWER) { // Wake up
+      Sleep.asleep = false;
+      digitalWrite(LED_BUILTIN, HIGH);
+      animate(ANIMATION_WIPE);
+    }
+    return;
+  }
+  switch (value) {
+    case KEY_FUNC_STOP: // Enter/exit IR mode
+      IRMode.enabled = !IRMode.enabled;
+      animate(IRMode.enabled ? ANIMATION_WIPE : ANIMATION_UNWIPE);
       break;
     case KEY_POWER: // Sleep mode
+      Sleep.asleep = true;
       digitalWrite(LED_BUILTIN, LOW);
-      animate(0);
-      irrecv.resume();
-      while (true) {
-        delay(50);
-        if (irrecv.decode(&irresults)) {
-          if (irresults.value == KEY_POWER) break;
-          irrecv.resume();
-        }
-      }
-      irrecv.resume();
-      digitalWrite(LED_BUILTIN, HIGH);
-      animate(1);
-      renderStaticWithMode();
+      animate(ANIMATION_OFF);
       break;
     case KEY_0:
-      Rendering.currentMode = 0;
-      renderStaticWithMode();
+      setMode(0);
+      showModeChange();
       break;
     case KEY_1: {
       if (Rendering.currentMode != 1) {
-        Rendering.currentMode = 1;
+        setMode(1);
       } else {
-        if (++mode1.submode >= 2) mode1.submode = 0;
+        if (++modeSettings.mode1Submode >= 2) modeSettings.mode1Submode = 0;
       }
-      renderStaticWithMode();
+      showModeChange();
       break;
     }
     case KEY_2:
       if (Rendering.currentMode != 2) {
-        Rendering.currentMode = 2;
+        setMode(2);
       } else {
-        if (++mode2.submode >= 4) mode2.submode = 0;
+        if (++modeSettings.mode2Submode >= 4) modeSettings.mode2Submode = 0;
       }
-      renderStaticWithMode();
+      showModeChange();
       break;
     case KEY_3:
-      Rendering.currentMode = 3;
-      renderStaticWithMode();
+      if (Rendering.currentMode != 3) {
+        setMode(3);
+      } else {
+        if (++modeSettings.mode3Submode >= 2) modeSettings.mode3Submode = 0;
+        mode_enter(3);
+      }
+      showModeChange();
       break;
     case KEY_4:
-      Rendering.currentMode = 4;
-      renderStaticWithMode();
+      setMode(4);
+      showModeChange();
       break;
     case KEY_5:
-      Rendering.currentMode = 5;
-      renderStaticWithMode();
+      setMode(5);
+      showModeChange();
+      break;
+    case KEY_6:
+      setMode(6);
+      showModeChange();
       break;
     case KEY_ST_REPT: {
       if (Rendering.currentMode == 4) {
-        mode4_editMode();
+        mode4_startEdit();
       } else if (Rendering.currentMode == 5) {
-        mode5_editMode();
+        mode5_startEdit();
       }
       break;
     }
     case KEY_PAUSE: {
       if (Rendering.currentMode == 5) {
         // Store current colour into EEPROM
-        EEPROM.update(0x0, mode5.red);
-        EEPROM.update(0x1, mode5.green);
-        EEPROM.update(0x2, mode5.blue);
-        animate(3);
-        delay(50);
-        renderStaticWithMode();
+        EEPROM.update(0x0, modeSettings.mode5Red);
+        EEPROM.update(0x1, modeSettings.mode5Green);
+        EEPROM.update(0x2, modeSettings.mode5Blue);
+        animate(ANIMATION_FLASH);
       }
       break;
     }
   }
 }
 
-void mode4_editMode() {
-  mode4_render(&diagram, true);
-  strip.show();
-  irrecv.resume();
-  while (true) {
-    delay(FRAME_DELAY);
-    if (irrecv.decode(&irresults)) {
-      unsigned long value = irresults.value;
-      switch (value) {
-        case KEY_ST_REPT: {
-          irrecv.resume();
-          renderStaticWithMode();
-          return;
-        }
-        case KEY_EQ: {
-          StationPath *route = &mode4.route;
-          uint8_t first = mode4.start;
-          uint8_t last = mode4.end;
-          mode4.start = last;
-          mode4.end = first;
-          pathfind(&mode4.route, last, first);
-          mode4_render(&diagram, true);
-          strip.show();
-          break;
-        }
-        case KEY_REWIND:
-        case KEY_FAST_FORWARD: {
-          int8_t last = (int8_t) mode4.end;
-          last += value == KEY_REWIND ? -1 : 1;
-          if (last < 0) last = NUM_STATIONS - 1;
-          if (last >= NUM_STATIONS) last = 0;
-          mode4.end = (uint8_t) last;
-          pathfind(&mode4.route, mode4.start, mode4.end);
-          mode4_render(&diagram, true);
-          strip.show();
-          break;
-        }
+bool editing() {
+  return Editor.mode != EDITOR_NONE;
+}
+
+// Brings the edited mode up to date with its settings. Returns false if
+// they haven't changed.
+bool updateEditor() {
+  if (!Editor.changed) return false;
+  Editor.changed = false;
+  if (Editor.mode == 4) routeFind(&modeState.mode4.route, modeSettings.mode4Start, modeSettings.mode4End);
+  return true;
+}
+
+// Draws the editor once per frame, however many keys changed it since the
+// last one (holding FFWD or REWIND can move the endpoint several stations
+// a frame, but the route is only found once).
+void renderEditor() {
+  if (updateEditor()) {
+    if (Editor.mode == 4) mode4_render(&diagram, true);
+    else mode5_render(&diagram, true, false);
+  }
+  scheduler.show();
+}
+
+void endEdit() {
+  updateEditor();
+  Editor.mode = EDITOR_NONE;
+  renderStaticWithMode();
+}
+
+void mode4_startEdit() {
+  Editor.mode = 4;
+  Editor.changed = true;
+}
+
+void mode4_editKey(const InputEvent *event) {
+  switch (event->key) {
+    case KEY_ST_REPT:
+      if (event->repeats == 0) endEdit();
+      break;
+    case KEY_EQ: {
+      if (event->repeats != 0) break;
+      station_t first = modeSettings.mode4Start;
+      modeSettings.mode4Start = modeSettings.mode4End;
+      modeSettings.mode4End = first;
+      Editor.changed = true;
+      break;
+    }
+    case KEY_REWIND:
+    case KEY_FAST_FORWARD: {
+      uint8_t steps = input_steps(event);
+      if (steps == 0) break;
+      uint16_t last = modeSettings.mode4End;
+      if (event->key == KEY_REWIND) {
+        last += NUM_STATIONS - steps;
+      } else {
+        last += steps;
       }
-      irrecv.resume();
+      modeSettings.mode4End = last % NUM_STATIONS;
+      Editor.changed = true;
+      break;
     }
   }
 }
 
-void mode5_bumpUp(uint8_t digit, uint16_t* rawValue) {
-  uint8_t steps = mode5.steps;
+void mode5_bumpUp(uint8_t digit) {
+  uint8_t steps = modeState.mode5.steps;
   uint8_t substep = steps % 3;
-  
+  uint16_t *rawValue = &Editor.rawValue;
+
+  // The old colour is shown until the first digit
+  if (steps == 0) modeSettings.mode5Red = modeSettings.mode5Green = modeSettings.mode5Blue = 0;
   (*rawValue) *= 10;
   (*rawValue) += digit % 10;
   if ((*rawValue) > 255) (*rawValue) = 255;
   if (steps / 3 == 0) {
-    mode5.red = (uint8_t) (*rawValue);
+    modeSettings.mode5Red = (uint8_t) (*rawValue);
   } else if (steps / 3 == 1) {
-    mode5.green = (uint8_t) (*rawValue);
+    modeSettings.mode5Green = (uint8_t) (*rawValue);
   } else if (steps / 3 == 2) {
-    mode5.blue = (uint8_t) (*rawValue);
+    modeSettings.mode5Blue = (uint8_t) (*rawValue);
   }
 
   if (substep == 2) (*rawValue) = 0;
-  mode5.steps++;
-  mode5_render(&diagram, true, false);
-  strip.show();
+  modeState.mode5.steps++;
+  Editor.changed = true;
 }
 
-void mode5_editMode() {
-  uint8_t oldRed = mode5.red;
-  uint8_t oldGreen = mode5.green;
-  uint8_t oldBlue = mode5.blue;
-  mode5.steps = 0;
-  mode5_render(&diagram, true, false);
-  strip.show();
-  mode5.red = mode5.blue = mode5.green = 0;
-  irrecv.resume();
-  uint16_t rawValue = 0;
-  while (true) {
-    delay(FRAME_DELAY);
-    if (irrecv.decode(&irresults)) {
-      unsigned long value = irresults.value;
-      switch (value) {
-        case KEY_ST_REPT: {
-          irrecv.resume();
-          mode5.red = oldRed;
-          mode5.green = oldGreen;
-          mode5.blue = oldBlue;
-          renderStaticWithMode();
-          return;
-        }
-        case KEY_PAUSE: {
-          irrecv.resume();
-          mode5.red = EEPROM.read(0x0);
-          mode5.green = EEPROM.read(0x1);
-          mode5.blue = EEPROM.read(0x2);
-          animate(3);
-          delay(50);
-          renderStaticWithMode();
-          return;
-        }
-        case KEY_0:
-          mode5_bumpUp(0, &rawValue);
-          break;
-        case KEY_1:
-          mode5_bumpUp(1, &rawValue);
-          break;
-        case KEY_2:
-          mode5_bumpUp(2, &rawValue);
-          break;
-        case KEY_3:
-          mode5_bumpUp(3, &rawValue);
-          break;
-        case KEY_4:
-          mode5_bumpUp(4, &rawValue);
-          break;
-        case KEY_5:
-          mode5_bumpUp(5, &rawValue);
-          break;
-        case KEY_6:
-          mode5_bumpUp(6, &rawValue);
-          break;
-        case KEY_7:
-          mode5_bumpUp(7, &rawValue);
-          break;
-        case KEY_8:
-          mode5_bumpUp(8, &rawValue);
-          break;
-        case KEY_9:
-          mode5_bumpUp(9, &rawValue);
-          break;
-      }
-      irrecv.resume();
-      if (mode5.steps >= 9) {
-        mode5.steps = 0;
-        renderStaticWithMode();
-        return;
-      }
-    }
+void mode5_startEdit() {
+  Editor.mode = 5;
+  Editor.oldRed = modeSettings.mode5Red;
+  Editor.oldGreen = modeSettings.mode5Green;
+  Editor.oldBlue = modeSettings.mode5Blue;
+  Editor.rawValue = 0;
+  modeState.mode5.steps = 0;
+  Editor.changed = true;
+}
+
+// The digit on a number key, or -1 for other keys.
+int8_t keyDigit(unsigned long value) {
+  switch (value) {
+    case KEY_0: return 0;
+    case KEY_1: return 1;
+    case KEY_2: return 2;
+    case KEY_3: return 3;
+    case KEY_4: return 4;
+    case KEY_5: return 5;
+    case KEY_6: return 6;
+    case KEY_7: return 7;
+    case KEY_8: return 8;
+    case KEY_9: return 9;
   }
+  return -1;
 }
 
-/*
- * 0 - Turn all pixels off
- * 1 - IR mode on / resume from sleep
- * 2 - IR mode off (reverse of 1)
- * 3 - Quick flash green
- */
-void animate(uint8_t id) {
-  switch(id) {
-    case 0:
-      strip.clear();
-      strip.show();
-      break;
-    case 1:
-    case 2:
-      strip.clear();
-      for (int i = 0; i < NUM_STATIONS; i++) {
-        for (int j = i; j >= 0; j--) {
-          diagram.set(STATION_X_ORDER[id == 2 ? (NUM_STATIONS - 1 - j) : j], strip.ColorHSV(65536 / NUM_STATIONS * (j - i)));
-        }
-        strip.show();
-        delay(7);
-      }
-      for (int i = 0; i < NUM_STATIONS; i++) {
-        for (int j = 0; j < NUM_STATIONS; j++) {
-          uint32_t c = j <= i ? 0 : strip.ColorHSV(65536 / NUM_STATIONS * (j - i));
-          diagram.set(STATION_X_ORDER[id == 2 ? (NUM_STATIONS - 1 - j) : j], c);
-        }
-        strip.show();
-        delay(7);
-      }
-      break;
-    case 3:
-      strip.clear();
-      for (int j = 0; j < 50; j++) {
-        uint32_t multiplier = (j >= 25 ? (50 - j) : j);
-        uint32_t c = (10 * multiplier) << 8;
-        for (int i = 0; i < NUM_STATIONS; i++) {
-          diagram.set(i, c);
-        }
-        strip.show();
-        delay(5);
-      }
-      strip.clear();
-      strip.show();
-      break;
+void mode5_editKey(const InputEvent *event) {
+  if (event->repeats != 0) return;
+  switch (event->key) {
+    case KEY_ST_REPT:
+      modeSettings.mode5Red = Editor.oldRed;
+      modeSettings.mode5Green = Editor.oldGreen;
+      modeSettings.mode5Blue = Editor.oldBlue;
+      endEdit();
+      return;
+    case KEY_PAUSE:
+      modeSettings.mode5Red = EEPROM.read(0x0);
+      modeSettings.mode5Green = EEPROM.read(0x1);
+      modeSettings.mode5Blue = EEPROM.read(0x2);
+      // The static preview is shown once the flash is over
+      Editor.mode = EDITOR_NONE;
+      animate(ANIMATION_FLASH);
+      return;
+  }
+  int8_t digit = keyDigit(event->key);
+  if (digit < 0) return;
+  mode5_bumpUp(digit);
+  if (modeState.mode5.steps >= 9) {
+    modeState.mode5.steps = 0;
+    endEdit();
   }
 }
+
+// Starts a transition animation (see animations.h). It plays over the next
+// frames, after which the static preview is shown if in IR mode.
+void animate(uint8_t id) {
+  animation_start(id);
+}
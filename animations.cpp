@@ -0,0 +1,55 @@
+#include <Arduino.h>
+#include "animations.h"
+#include "diagram.h"
+#include "stations.h"
+#include "utils.h"
+#include "curves.h"
+#include "clip.h"
+
+// Timing is in powers of two ms, so steps and phases are found with shifts.
+#define FLASH_BITS      8 // A 256 ms pulse
+// The flash ends with the diagram dark for a moment.
+#define FLASH_OFF_TIME  50
+
+Animation animation;
+
+void animation_start(uint8_t id) {
+  animation.id = id;
+  animation.startTime = millis();
+  // The wipe is a clip (see clip.h), the unwipe is the same clip mirrored
+  if (id == ANIMATION_WIPE || id == ANIMATION_UNWIPE) clip_start(&animation.clip, CLIP_WIPE, id == ANIMATION_UNWIPE);
+}
+
+bool animation_playing() {
+  return animation.id != ANIMATION_NONE;
+}
+
+static bool animation_renderFlash(LineDiagram *diagram, unsigned long elapsed) {
+  diagram->clear();
+  if (elapsed < (1UL << FLASH_BITS)) {
+    uint32_t c = (uint32_t) curve(CURVE_PULSE, elapsed << (16 - FLASH_BITS)) << 8;
+    for (int i = 0; i < NUM_STATIONS; i++) {
+      diagram->set(i, c);
+    }
+  }
+  return elapsed < (1UL << FLASH_BITS) + FLASH_OFF_TIME;
+}
+
+bool animation_render(LineDiagram *diagram) {
+  unsigned long elapsed = millis() - animation.startTime;
+  bool playing = false;
+  switch (animation.id) {
+    case ANIMATION_OFF:
+      diagram->clear();
+      break;
+    case ANIMATION_WIPE:
+    case ANIMATION_UNWIPE:
+      playing = clip_render(&animation.clip, diagram, elapsed);
+      break;
+    case ANIMATION_FLASH:
+      playing = animation_renderFlash(diagram, elapsed);
+      break;
+  }
+  if (!playing) animation.id = ANIMATION_NONE;
+  return playing;
+}
@@ -0,0 +1,32 @@
+// Transition animations, played one frame at a time.
+// An animation is a function of the time since it started, so each call to
+// animation_render() draws whatever step is due and returns straight away.
+// The main loop keeps polling IR and updating timers while it plays.
+// Starting an animation replaces one that is still playing.
+
+#ifndef _MKIII_ANIMATIONS_H
+#define _MKIII_ANIMATIONS_H
+
+#include "diagram.h"
+#include "clip.h"
+
+#define ANIMATION_NONE   0xFF
+#define ANIMATION_OFF    0 // Turn all pixels off
+#define ANIMATION_WIPE   1 // IR mode on / resume from sleep
+#define ANIMATION_UNWIPE 2 // IR mode off (reverse of the wipe)
+#define ANIMATION_FLASH  3 // Quick flash green
+
+typedef struct Animation {
+  uint8_t id = ANIMATION_NONE;
+  unsigned long startTime = 0;
+  ClipPlayer clip;
+} Animation;
+extern Animation animation;
+
+void animation_start(uint8_t id);
+bool animation_playing();
+// Draws the current step of the animation.
+// Returns false once the animation has finished (after drawing its last step).
+bool animation_render(LineDiagram *diagram);
+
+#endif
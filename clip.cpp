@@ -0,0 +1,51 @@
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "clip.h"
+#include "diagram.h"
+#include "stations.h"
+#include "utils.h"
+
+#define CLIP_FRAMES  0
+#define CLIP_BITS    2
+#define CLIP_COLORS  3
+#define CLIP_PALETTE 4
+
+void clip_start(ClipPlayer *player, const uint8_t *clip, bool mirror) {
+  player->clip = clip;
+  player->offset = CLIP_PALETTE + 3 * pgm_read_byte(&clip[CLIP_COLORS]);
+  player->frame = 0;
+  player->mirror = mirror;
+}
+
+static void clip_set(ClipPlayer *player, LineDiagram *diagram, station_t x, uint8_t index) {
+  const uint8_t *color = &player->clip[CLIP_PALETTE + 3 * index];
+  station_t stn = stationAtX(player->mirror ? NUM_STATIONS - 1 - x : x);
+  diagram->set(stn, rgb32(pgm_read_byte(&color[0]), pgm_read_byte(&color[1]), pgm_read_byte(&color[2])));
+}
+
+bool clip_render(ClipPlayer *player, LineDiagram *diagram, unsigned long elapsed) {
+  const uint8_t *clip = player->clip;
+  uint16_t frames = pgm_read_word(&clip[CLIP_FRAMES]);
+  unsigned long due = elapsed >> pgm_read_byte(&clip[CLIP_BITS]);
+  // Frames that were missed are applied in turn, as each builds on the last
+  while (player->frame < frames && player->frame <= due) {
+    const uint8_t *data = &clip[player->offset];
+    uint8_t runs = pgm_read_byte(data++);
+    if (runs == CLIP_KEYFRAME) {
+      for (station_t x = 0; x < NUM_STATIONS; x++) {
+        clip_set(player, diagram, x, pgm_read_byte(data++));
+      }
+    } else {
+      for (uint8_t i = 0; i < runs; i++) {
+        uint8_t x = pgm_read_byte(data++);
+        uint8_t length = pgm_read_byte(data++);
+        for (uint8_t end = x + length; x < end; x++) {
+          clip_set(player, diagram, x, pgm_read_byte(data++));
+        }
+      }
+    }
+    player->offset = data - clip;
+    player->frame++;
+  }
+  return player->frame < frames;
+}
@@ -0,0 +1,39 @@
+// Plays pre-rendered animations ("clips") from flash, one frame at a time.
+// Clips are generated by tools/gen_clips.py into clip_data.h and
+// clip_data.cpp. Only the player's position is kept in RAM, so a clip costs
+// table reads rather than per-pixel maths, however long it is.
+//
+// Format (bytes):
+// - Frame count (16 bit, little endian), then the frame time as a power of
+//   two ms (bits), then the palette size and the palette (red, green, blue
+//   for each colour).
+// - Each frame, either a keyframe: CLIP_KEYFRAME followed by a palette index
+//   for every station by left-to-right position, or the changes since the
+//   previous frame: the number of runs, then for each run its first position,
+//   its length and a palette index for each position in it.
+// The first frame is always a keyframe. Positions are left to right on the
+// diagram, so a clip can also be played mirrored.
+
+#ifndef _MKIII_CLIP_H
+#define _MKIII_CLIP_H
+
+#include <stdint.h>
+#include "diagram.h"
+#include "clip_data.h"
+
+#define CLIP_KEYFRAME 0xFF
+
+typedef struct ClipPlayer {
+  const uint8_t *clip;
+  // Where the next frame starts in the clip
+  uint16_t offset;
+  uint16_t frame;
+  bool mirror;
+} ClipPlayer;
+
+void clip_start(ClipPlayer *player, const uint8_t *clip, bool mirror);
+// Draws every frame that is due elapsed ms after the start.
+// Returns false once the last frame has been drawn.
+bool clip_render(ClipPlayer *player, LineDiagram *diagram, unsigned long elapsed);
+
+#endif
@@ -0,0 +1,133 @@
+// Generated by tools/gen_clips.py. Do not edit by hand.
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "clip_data.h"
+
+// 78 frames of 8 ms, 52 colours, 7 keyframes: 1984 bytes (9126 raw)
+const uint8_t CLIP_WIPE[1984] PROGMEM = {
+  78, 0, 3, 52, 255, 0, 0, 0, 0, 0, 255, 0, 40, 255, 0, 79,
+  255, 0, 119, 255, 0, 157, 255, 0, 196, 255, 0, 236, 235, 0, 255, 196,
+  0, 255, 156, 0, 255, 118, 0, 255, 78, 0, 255, 39, 0, 255, 1, 2,
+  255, 0, 40, 255, 0, 79, 255, 0, 118, 255, 0, 157, 255, 0, 196, 255,
+  0, 236, 255, 0, 255, 235, 0, 255, 196, 0, 255, 156, 0, 255, 118, 0,
+  255, 79, 0, 255, 39, 2, 255, 1, 40, 255, 0, 79, 255, 0, 118, 255,
+  0, 157, 255, 0, 196, 255, 0, 235, 255, 0, 255, 235, 0, 255, 196, 0,
+  255, 156, 0, 255, 118, 0, 255, 79, 0, 255, 39, 0, 255, 78, 0, 255,
+  195, 0, 236, 255, 0, 119, 255, 0, 0, 255, 78, 0, 255, 195, 0, 197,
+  255, 0, 119, 255, 117, 0, 255, 195, 0, 255, 255, 0, 197, 255, 0, 80,
+  255, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 2, 2, 0, 1, 0, 3,
+  3, 2, 0, 1, 0, 4, 4, 3, 2, 0, 1, 0, 5, 5, 4, 3,
+  2, 0, 1, 0, 6, 6, 5, 4, 3, 2, 0, 1, 0, 7, 7, 6,
+  5, 4, 3, 2, 0, 1, 0, 8, 8, 7, 6, 5, 4, 3, 2, 0,
+  1, 0, 9, 9, 8, 7, 6, 5, 4, 3, 2, 0, 1, 0, 10, 10,
+  9, 8, 7, 6, 5, 4, 3, 2, 0, 1, 0, 11, 11, 10, 9, 8,
+  7, 6, 5, 4, 3, 2, 0, 1, 0, 12, 12, 11, 10, 9, 8, 7,
+  6, 5, 4, 3, 2, 0, 1, 0, 13, 13, 12, 11, 10, 9, 8, 7,
+  6, 5, 4, 3, 2, 0, 1, 0, 14, 14, 13, 12, 11, 10, 9, 8,
+  7, 6, 5, 4, 3, 2, 0, 1, 0, 15, 15, 14, 13, 12, 11, 10,
+  9, 8, 7, 6, 5, 4, 3, 2, 0, 1, 0, 16, 16, 15, 14, 13,
+  12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 1, 0, 17, 17,
+  16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 0,
+  1, 0, 18, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6,
+  5, 4, 3, 2, 0, 1, 0, 19, 19, 18, 17, 16, 15, 14, 13, 12,
+  11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 1, 0, 20, 20, 19,
+  18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3,
+  2, 0, 1, 0, 21, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11,
+  10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 1, 0, 22, 22, 21, 20,
+  19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4,
+  3, 2, 0, 1, 0, 23, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14,
+  13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 1, 0, 24,
+  24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9,
+  8, 7, 6, 5, 4, 3, 2, 0, 1, 0, 25, 25, 24, 23, 22, 21,
+  20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5,
+  4, 3, 2, 0, 1, 0, 26, 26, 25, 24, 23, 22, 21, 20, 19, 18,
+  17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2,
+  0, 1, 0, 27, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16,
+  15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 1,
+  0, 28, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15,
+  14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 1, 0,
+  29, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15,
+  14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 1, 0,
+  30, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16,
+  15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 1,
+  0, 31, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18,
+  17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2,
+  0, 1, 0, 32, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21,
+  20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5,
+  4, 3, 2, 0, 1, 0, 33, 33, 32, 31, 30, 29, 28, 27, 26, 25,
+  24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9,
+  8, 7, 6, 5, 4, 3, 2, 0, 1, 0, 34, 34, 33, 32, 31, 30,
+  29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14,
+  13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 1, 0, 35,
+  35, 34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20,
+  19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4,
+  3, 2, 0, 1, 0, 36, 36, 35, 34, 33, 32, 31, 30, 29, 28, 27,
+  26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11,
+  10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 255, 37, 36, 35, 34, 33,
+  32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+  16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 0,
+  1, 1, 255, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29, 28, 27, 26,
+  25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10,
+  9, 8, 7, 6, 5, 4, 3, 2, 0, 1, 255, 39, 38, 37, 36, 35,
+  34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19,
+  18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3,
+  2, 0, 255, 1, 39, 40, 37, 36, 41, 34, 42, 32, 31, 43, 29, 28,
+  27, 26, 44, 24, 23, 45, 21, 20, 46, 18, 47, 16, 15, 14, 13, 12,
+  48, 10, 49, 8, 7, 50, 5, 4, 51, 2, 255, 1, 1, 39, 40, 37,
+  36, 41, 34, 42, 32, 31, 43, 29, 28, 27, 26, 44, 24, 23, 45, 21,
+  20, 46, 18, 47, 16, 15, 14, 13, 12, 48, 10, 49, 8, 7, 50, 5,
+  4, 51, 255, 1, 1, 1, 39, 40, 37, 36, 41, 34, 42, 32, 31, 43,
+  29, 28, 27, 26, 44, 24, 23, 45, 21, 20, 46, 18, 47, 16, 15, 14,
+  13, 12, 48, 10, 49, 8, 7, 50, 5, 4, 1, 3, 36, 1, 39, 40,
+  37, 36, 41, 34, 42, 32, 31, 43, 29, 28, 27, 26, 44, 24, 23, 45,
+  21, 20, 46, 18, 47, 16, 15, 14, 13, 12, 48, 10, 49, 8, 7, 50,
+  5, 1, 4, 35, 1, 39, 40, 37, 36, 41, 34, 42, 32, 31, 43, 29,
+  28, 27, 26, 44, 24, 23, 45, 21, 20, 46, 18, 47, 16, 15, 14, 13,
+  12, 48, 10, 49, 8, 7, 50, 1, 5, 34, 1, 39, 40, 37, 36, 41,
+  34, 42, 32, 31, 43, 29, 28, 27, 26, 44, 24, 23, 45, 21, 20, 46,
+  18, 47, 16, 15, 14, 13, 12, 48, 10, 49, 8, 7, 1, 6, 33, 1,
+  39, 40, 37, 36, 41, 34, 42, 32, 31, 43, 29, 28, 27, 26, 44, 24,
+  23, 45, 21, 20, 46, 18, 47, 16, 15, 14, 13, 12, 48, 10, 49, 8,
+  1, 7, 32, 1, 39, 40, 37, 36, 41, 34, 42, 32, 31, 43, 29, 28,
+  27, 26, 44, 24, 23, 45, 21, 20, 46, 18, 47, 16, 15, 14, 13, 12,
+  48, 10, 49, 1, 8, 31, 1, 39, 40, 37, 36, 41, 34, 42, 32, 31,
+  43, 29, 28, 27, 26, 44, 24, 23, 45, 21, 20, 46, 18, 47, 16, 15,
+  14, 13, 12, 48, 10, 1, 9, 30, 1, 39, 40, 37, 36, 41, 34, 42,
+  32, 31, 43, 29, 28, 27, 26, 44, 24, 23, 45, 21, 20, 46, 18, 47,
+  16, 15, 14, 13, 12, 48, 1, 10, 29, 1, 39, 40, 37, 36, 41, 34,
+  42, 32, 31, 43, 29, 28, 27, 26, 44, 24, 23, 45, 21, 20, 46, 18,
+  47, 16, 15, 14, 13, 12, 1, 11, 28, 1, 39, 40, 37, 36, 41, 34,
+  42, 32, 31, 43, 29, 28, 27, 26, 44, 24, 23, 45, 21, 20, 46, 18,
+  47, 16, 15, 14, 13, 1, 12, 27, 1, 39, 40, 37, 36, 41, 34, 42,
+  32, 31, 43, 29, 28, 27, 26, 44, 24, 23, 45, 21, 20, 46, 18, 47,
+  16, 15, 14, 1, 13, 26, 1, 39, 40, 37, 36, 41, 34, 42, 32, 31,
+  43, 29, 28, 27, 26, 44, 24, 23, 45, 21, 20, 46, 18, 47, 16, 15,
+  1, 14, 25, 1, 39, 40, 37, 36, 41, 34, 42, 32, 31, 43, 29, 28,
+  27, 26, 44, 24, 23, 45, 21, 20, 46, 18, 47, 16, 1, 15, 24, 1,
+  39, 40, 37, 36, 41, 34, 42, 32, 31, 43, 29, 28, 27, 26, 44, 24,
+  23, 45, 21, 20, 46, 18, 47, 1, 16, 23, 1, 39, 40, 37, 36, 41,
+  34, 42, 32, 31, 43, 29, 28, 27, 26, 44, 24, 23, 45, 21, 20, 46,
+  18, 1, 17, 22, 1, 39, 40, 37, 36, 41, 34, 42, 32, 31, 43, 29,
+  28, 27, 26, 44, 24, 23, 45, 21, 20, 46, 1, 18, 21, 1, 39, 40,
+  37, 36, 41, 34, 42, 32, 31, 43, 29, 28, 27, 26, 44, 24, 23, 45,
+  21, 20, 1, 19, 20, 1, 39, 40, 37, 36, 41, 34, 42, 32, 31, 43,
+  29, 28, 27, 26, 44, 24, 23, 45, 21, 1, 20, 19, 1, 39, 40, 37,
+  36, 41, 34, 42, 32, 31, 43, 29, 28, 27, 26, 44, 24, 23, 45, 1,
+  21, 18, 1, 39, 40, 37, 36, 41, 34, 42, 32, 31, 43, 29, 28, 27,
+  26, 44, 24, 23, 1, 22, 17, 1, 39, 40, 37, 36, 41, 34, 42, 32,
+  31, 43, 29, 28, 27, 26, 44, 24, 1, 23, 16, 1, 39, 40, 37, 36,
+  41, 34, 42, 32, 31, 43, 29, 28, 27, 26, 44, 1, 24, 15, 1, 39,
+  40, 37, 36, 41, 34, 42, 32, 31, 43, 29, 28, 27, 26, 1, 25, 14,
+  1, 39, 40, 37, 36, 41, 34, 42, 32, 31, 43, 29, 28, 27, 1, 26,
+  13, 1, 39, 40, 37, 36, 41, 34, 42, 32, 31, 43, 29, 28, 1, 27,
+  12, 1, 39, 40, 37, 36, 41, 34, 42, 32, 31, 43, 29, 1, 28, 11,
+  1, 39, 40, 37, 36, 41, 34, 42, 32, 31, 43, 1, 29, 10, 1, 39,
+  40, 37, 36, 41, 34, 42, 32, 31, 1, 30, 9, 1, 39, 40, 37, 36,
+  41, 34, 42, 32, 1, 31, 8, 1, 39, 40, 37, 36, 41, 34, 42, 1,
+  32, 7, 1, 39, 40, 37, 36, 41, 34, 1, 33, 6, 1, 39, 40, 37,
+  36, 41, 1, 34, 5, 1, 39, 40, 37, 36, 1, 35, 4, 1, 39, 40,
+  37, 1, 36, 3, 1, 39, 40, 1, 37, 2, 1, 39, 1, 38, 1, 1
+};
@@ -0,0 +1,11 @@
+// Generated by tools/gen_clips.py. Do not edit by hand.
+
+#ifndef _MKIII_CLIP_DATA_H
+#define _MKIII_CLIP_DATA_H
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+extern const uint8_t CLIP_WIPE[1984] PROGMEM;
+
+#endif
@@ -0,0 +1,17 @@
+// Colour kernels shared by the modes and animations.
+
+#ifndef _MKIII_COLORS_H
+#define _MKIII_COLORS_H
+
+#include <stdint.h>
+#include "diagram.h"
+
+// Fully saturated colour for a hue on the 16 bit colour wheel
+// (the same as Adafruit_NeoPixel::ColorHSV(hue), to within 2 levels).
+uint32_t hueColor(uint16_t hue);
+
+// Sets count stations, starting from the first, to a rainbow:
+// the i-th station gets the colour for hue start + i * step.
+void hueGradient(LineDiagram *diagram, uint16_t first, uint16_t count, uint16_t start, uint16_t step);
+
+#endif
@@ -0,0 +1,76 @@
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "curves.h"
+
+// The triangle and ease curves are symmetric, so their tables only hold
+// the rising half, 256 steps over half a cycle. The triangle's rising half
+// is the step itself, so it needs no table.
+
+// 3x^2 - 2x^3 over the rising half
+const uint8_t CURVE_EASE_TABLE[256] PROGMEM = {
+  0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 2, 2, 2, 3,
+  3, 3, 4, 4, 4, 5, 5, 6, 6, 7, 7, 8, 9, 9, 10, 10,
+  11, 12, 12, 13, 14, 15, 15, 16, 17, 18, 18, 19, 20, 21, 22, 23,
+  24, 25, 26, 27, 27, 28, 29, 30, 31, 33, 34, 35, 36, 37, 38, 39,
+  40, 41, 42, 44, 45, 46, 47, 48, 50, 51, 52, 53, 54, 56, 57, 58,
+  60, 61, 62, 63, 65, 66, 67, 69, 70, 72, 73, 74, 76, 77, 78, 80,
+  81, 83, 84, 85, 87, 88, 90, 91, 93, 94, 96, 97, 98, 100, 101, 103,
+  104, 106, 107, 109, 110, 112, 113, 115, 116, 118, 119, 121, 122, 124, 125, 127,
+  128, 130, 131, 133, 134, 136, 137, 139, 140, 142, 143, 145, 146, 148, 149, 151,
+  152, 154, 155, 157, 158, 159, 161, 162, 164, 165, 167, 168, 170, 171, 172, 174,
+  175, 177, 178, 179, 181, 182, 183, 185, 186, 188, 189, 190, 192, 193, 194, 195,
+  197, 198, 199, 201, 202, 203, 204, 205, 207, 208, 209, 210, 211, 213, 214, 215,
+  216, 217, 218, 219, 220, 221, 222, 224, 225, 226, 227, 228, 228, 229, 230, 231,
+  232, 233, 234, 235, 236, 237, 237, 238, 239, 240, 240, 241, 242, 243, 243, 244,
+  245, 245, 246, 246, 247, 248, 248, 249, 249, 250, 250, 251, 251, 251, 252, 252,
+  252, 253, 253, 253, 254, 254, 254, 254, 254, 255, 255, 255, 255, 255, 255, 255
+};
+
+// Over the whole cycle: 3x^2 - 2x^3 for the first quarter, then (1 - x)^2
+// over the other three quarters.
+const uint8_t CURVE_PULSE_TABLE[256] PROGMEM = {
+  0, 0, 1, 2, 3, 4, 6, 8, 11, 14, 17, 20, 24, 27, 31, 35,
+  40, 44, 49, 54, 59, 64, 70, 75, 81, 86, 92, 98, 104, 110, 116, 122,
+  128, 133, 139, 145, 151, 157, 163, 169, 174, 180, 185, 191, 196, 201, 206, 211,
+  215, 220, 224, 228, 231, 235, 238, 241, 244, 247, 249, 251, 252, 253, 254, 255,
+  255, 252, 250, 247, 244, 242, 239, 237, 234, 232, 229, 227, 224, 222, 219, 217,
+  214, 212, 209, 207, 205, 202, 200, 198, 195, 193, 191, 188, 186, 184, 182, 179,
+  177, 175, 173, 171, 168, 166, 164, 162, 160, 158, 156, 154, 152, 149, 147, 145,
+  143, 141, 139, 138, 136, 134, 132, 130, 128, 126, 124, 122, 121, 119, 117, 115,
+  113, 112, 110, 108, 106, 105, 103, 101, 100, 98, 96, 95, 93, 91, 90, 88,
+  87, 85, 84, 82, 81, 79, 78, 76, 75, 73, 72, 71, 69, 68, 66, 65,
+  64, 62, 61, 60, 59, 57, 56, 55, 54, 52, 51, 50, 49, 48, 47, 45,
+  44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29,
+  28, 27, 27, 26, 25, 24, 23, 22, 22, 21, 20, 19, 19, 18, 17, 17,
+  16, 15, 15, 14, 13, 13, 12, 12, 11, 11, 10, 9, 9, 8, 8, 8,
+  7, 7, 6, 6, 5, 5, 5, 4, 4, 4, 3, 3, 3, 2, 2, 2,
+  2, 2, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+uint8_t curve(uint8_t id, uint16_t phase) {
+  if (id == CURVE_PULSE) return pgm_read_byte(&CURVE_PULSE_TABLE[phase >> 8]);
+  uint8_t step = phase >> 7;
+  if (phase & 0x8000) step = ~step;
+  if (id == CURVE_TRIANGLE) return step;
+  return pgm_read_byte(&CURVE_EASE_TABLE[step]);
+}
+
+void phase_start(Phase *phase, unsigned long ms) {
+  phase->value = 0;
+  phase->lastTime = ms;
+}
+
+uint16_t phase_advance(Phase *phase, unsigned long ms, uint8_t periodBits) {
+  // Only the low bits of the time matter, as the phase wraps anyway
+  uint16_t elapsed = ms - phase->lastTime;
+  phase->lastTime = ms;
+  phase->value += elapsed << (16 - periodBits);
+  return phase->value;
+}
+
+unsigned long phase_nextStep(const Phase *phase, uint8_t stepBits, uint8_t periodBits) {
+  uint8_t shift = 16 - periodBits;
+  unsigned long left = (1UL << stepBits) - (phase->value & ((1U << stepBits) - 1));
+  // Rounded up to whole ms
+  return phase->lastTime + ((left + (1UL << shift) - 1) >> shift);
+}
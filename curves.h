@@ -0,0 +1,37 @@
+// Fixed-point curves for animations.
+// A cycle is a 16 bit phase (0 to 65535). When a cycle is a power of two ms
+// long, the phase is the time shifted up, and a curve is evaluated with a
+// shift and a table read (no multiplies or divides). Curves give levels from
+// 0 to 255.
+//
+// A Phase keeps a mode's position in its cycle. It is advanced from
+// millis() each frame, so a mode's cycle starts when the mode does, and it
+// can tell when the phase next crosses a step (e.g. to know how long the
+// display can idle, see modes.h).
+
+#ifndef _MKIII_CURVES_H
+#define _MKIII_CURVES_H
+
+#include <stdint.h>
+
+#define CURVE_TRIANGLE 0 // Linear, 0 up to 255 at half a cycle and back down
+#define CURVE_EASE     1 // As the triangle, eased in and out (smoothstep)
+#define CURVE_PULSE    2 // Eased up to 255 in a quarter cycle, then decays
+
+uint8_t curve(uint8_t id, uint16_t phase);
+
+typedef struct Phase {
+  uint16_t value;
+  unsigned long lastTime;
+} Phase;
+
+// Starts the phase at 0, from ms.
+void phase_start(Phase *phase, unsigned long ms);
+// Moves the phase on to ms, for a cycle of 2^periodBits ms (periodBits at
+// most 16). Returns the new phase.
+uint16_t phase_advance(Phase *phase, unsigned long ms, uint8_t periodBits);
+// The millis() at which the phase next reaches a multiple of 2^stepBits
+// (stepBits at most 15).
+unsigned long phase_nextStep(const Phase *phase, uint8_t stepBits, uint8_t periodBits);
+
+#endif
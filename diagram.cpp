@@ -1,12 +1,288 @@
+#include <Arduino.h>
 #include <Adafruit_NeoPixel.h>
 #include "diagram.h"
+#include "curves.h"
 #include "stations.h"
 #include "utils.h"
+#include "profile.h"
+
+// Byte offsets of each channel in the strip's pixel data (NEO_GRB, which
+// every output's strip must use).
+#define PIXEL_R 1
+#define PIXEL_G 0
+#define PIXEL_B 2
+
+#define DEFAULT_BRIGHTNESS 255
+
+// Gamma 2.6 curve (the same one the Adafruit_NeoPixel gamma functions use)
+// at 16 bit precision, so that it can be scaled down by the brightness
+// without losing the low levels.
+const uint16_t GAMMA_16[256] PROGMEM = {
+  0, 0, 0, 1, 1, 2, 4, 6, 8, 11, 14, 18,
+  23, 29, 35, 41, 49, 57, 67, 77, 88, 99, 112, 126,
+  141, 156, 173, 191, 210, 230, 251, 274, 297, 322, 348, 375,
+  404, 433, 464, 497, 531, 566, 602, 640, 680, 721, 763, 807,
+  853, 899, 948, 998, 1050, 1103, 1158, 1215, 1273, 1333, 1394, 1458,
+  1523, 1590, 1658, 1729, 1801, 1875, 1951, 2029, 2109, 2190, 2274, 2359,
+  2446, 2536, 2627, 2720, 2816, 2913, 3012, 3114, 3217, 3323, 3431, 3541,
+  3653, 3767, 3883, 4001, 4122, 4245, 4370, 4498, 4627, 4759, 4893, 5030,
+  5169, 5310, 5453, 5599, 5747, 5898, 6051, 6206, 6364, 6525, 6688, 6853,
+  7021, 7191, 7364, 7539, 7717, 7897, 8080, 8266, 8454, 8645, 8838, 9034,
+  9233, 9434, 9638, 9845, 10055, 10267, 10482, 10699, 10920, 11143, 11369, 11598,
+  11829, 12064, 12301, 12541, 12784, 13030, 13279, 13530, 13785, 14042, 14303, 14566,
+  14832, 15102, 15374, 15649, 15928, 16209, 16493, 16781, 17071, 17365, 17661, 17961,
+  18264, 18570, 18879, 19191, 19507, 19825, 20147, 20472, 20800, 21131, 21466, 21804,
+  22145, 22489, 22837, 23188, 23542, 23899, 24260, 24625, 24992, 25363, 25737, 26115,
+  26496, 26880, 27268, 27659, 28054, 28452, 28854, 29259, 29667, 30079, 30495, 30914,
+  31337, 31763, 32192, 32626, 33062, 33503, 33947, 34394, 34846, 35300, 35759, 36221,
+  36687, 37156, 37629, 38106, 38586, 39071, 39558, 40050, 40545, 41045, 41547, 42054,
+  42565, 43079, 43597, 44119, 44644, 45174, 45707, 46245, 46786, 47331, 47880, 48432,
+  48989, 49550, 50114, 50683, 51255, 51832, 52412, 52996, 53585, 54177, 54773, 55374,
+  55978, 56587, 57199, 57816, 58436, 59061, 59690, 60323, 60960, 61601, 62246, 62896,
+  63549, 64207, 64869, 65535
+};
+
+// Lower a channel here if an LED is brighter or tinted compared to its
+// neighbours.
+const uint8_t STATION_CALIBRATION[NUM_STATIONS][3] PROGMEM = {
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255},
+  {255, 255, 255}
+};
 
 LineDiagram::LineDiagram(Adafruit_NeoPixel *strip) {
   this->strip = strip;
+  memset(frame, 0, sizeof(frame));
+  memset(touched, 0, sizeof(touched));
+  addOutput(strip, 0, STATION_CALIBRATION, 0);
+  setBrightness(DEFAULT_BRIGHTNESS);
+}
+
+bool LineDiagram::addOutput(Adafruit_NeoPixel *strip, uint16_t offset, const uint8_t (*calibration)[3], uint8_t phase) {
+  if (outputCount == MAX_DIAGRAM_OUTPUTS || offset + NUM_STATIONS > strip->numPixels()) return false;
+  DiagramOutput *output = &outputs[outputCount++];
+  output->strip = strip;
+  output->offset = offset;
+  output->calibration = calibration;
+  output->phase = phase;
+  // A strip that is already sent doesn't add to the time a send takes
+  uint16_t length = 0;
+  for (uint8_t i = 0; i < outputCount; i++) {
+    bool counted = false;
+    for (uint8_t j = 0; j < i && !counted; j++) counted = outputs[j].strip == outputs[i].strip;
+    if (!counted) length += outputs[i].strip->numPixels();
+  }
+  displays = (length + NUM_STATIONS - 1) / NUM_STATIONS;
+  dirty = true;
+  return true;
+}
+
+uint8_t LineDiagram::sendDisplays() {
+  return displays;
+}
+
+void LineDiagram::setBrightness(uint8_t brightness) {
+  this->brightness = brightness;
 }
 
 void LineDiagram::set(uint16_t stn, uint32_t color, bool gamma) {
-  strip->setPixelColor(stn, gamma ? gamma32(color) : color);
+  if (stn >= NUM_STATIONS) return;
+  uint8_t input[3] = {(uint8_t) (color >> 16), (uint8_t) (color >> 8), (uint8_t) color};
+  uint16_t scale = brightness + 1;
+  uint16_t *levels = frame[stn];
+  for (uint8_t i = 0; i < 3; i++) {
+    uint16_t level;
+    if (gamma) {
+      level = ((uint32_t) pgm_read_word(&GAMMA_16[input[i]]) * scale) >> 8;
+    } else {
+      level = input[i] * scale;
+    }
+    if (levels[i] != level) {
+      levels[i] = level;
+      dirty = true;
+    }
+  }
+  bitsetSet(touched, stn);
+#ifdef MKIII_RENDER_STATS
+  stats.pixelWrites++;
+#endif
+}
+
+void LineDiagram::clear() {
+  memset(touched, 0, sizeof(touched));
+  clearPending = true;
+}
+
+bool LineDiagram::fading() {
+  return fadeBits != 0;
+}
+
+uint16_t LineDiagram::fadeWeight() {
+  unsigned long elapsed = millis() - fadeStart;
+  if (elapsed >> fadeBits) return 256;
+  // The rising half of the curve
+  return curve(CURVE_EASE, elapsed << (15 - fadeBits));
+}
+
+// Blends a channel from level a (8 bit) to level b (8.8) by weight.
+static inline uint16_t blend(uint8_t a, uint16_t b, uint16_t weight) {
+  uint16_t from = (uint16_t) a << 8;
+  return from + (((int32_t) b - from) * weight >> 8);
+}
+
+void LineDiagram::crossfade(uint8_t bits) {
+  uint16_t weight = fading() ? fadeWeight() : 256;
+  for (uint16_t stn = 0; stn < NUM_STATIONS; stn++) {
+    for (uint8_t i = 0; i < 3; i++) {
+      fadeLevels[stn][i] = blend(fadeLevels[stn][i], frame[stn][i], weight) >> 8;
+    }
+  }
+  fadeBits = bits;
+  fadeStart = millis();
+}
+
+bool LineDiagram::changed() {
+  if (clearPending) {
+    clearPending = false;
+    for (uint16_t i = 0; i < NUM_STATIONS; i++) {
+      if (bitsetGet(touched, i)) continue;
+      uint16_t *levels = frame[i];
+      if (levels[0] | levels[1] | levels[2]) {
+        levels[0] = levels[1] = levels[2] = 0;
+        dirty = true;
+      }
+    }
+  }
+  return dirty || fading();
+}
+
+bool LineDiagram::commit() {
+  if (!changed()) return false;
+  show();
+  return true;
+}
+
+bool LineDiagram::dithering() {
+  return fractional;
+}
+
+void LineDiagram::show() {
+  changed();
+  dirty = false;
+  send();
+#ifdef MKIII_RENDER_STATS
+  stats.shows++;
+#endif
+}
+
+void LineDiagram::refresh() {
+  send();
+#ifdef MKIII_RENDER_STATS
+  stats.refreshes++;
+#endif
+}
+
+// Scales a channel by a calibration factor out of 255.
+static inline uint16_t calibrate(uint16_t level, uint8_t factor) {
+  if (factor == 255) return level;
+  return ((uint32_t) level * (factor + 1)) >> 8;
+}
+
+// Output level for a channel: rounded up if its fraction is above the
+// threshold.
+static inline uint8_t dither(uint16_t level, uint8_t threshold) {
+  uint8_t output = level >> 8;
+  if ((uint8_t) level > threshold && output < 255) output++;
+  return output;
+}
+
+// The thresholds of each send are the send count with its bits reversed, so
+// consecutive sends are far apart (0, 128, 64, 192, ...). Stepping by an odd
+// amount per station keeps every station going through all 256 values.
+#define DITHER_STATION_STEP 89
+
+static uint8_t reverseBits(uint8_t x) {
+  x = (x >> 4) | (x << 4);
+  x = ((x & 0xCC) >> 2) | ((x & 0x33) << 2);
+  return ((x & 0xAA) >> 1) | ((x & 0x55) << 1);
+}
+
+void LineDiagram::send() {
+  PROFILE_SCOPE(PROBE_SHOW);
+  uint8_t base = reverseBits(sends++);
+  uint8_t fractions = 0;
+  uint16_t weight = 256;
+  if (fading()) {
+    weight = fadeWeight();
+    if (weight == 256) fadeBits = 0; // This send shows the frame as it is
+  }
+  for (uint8_t i = 0; i < outputCount; i++) {
+    const DiagramOutput *output = &outputs[i];
+    uint8_t *pixel = output->strip->getPixels() + output->offset * 3;
+    uint8_t threshold = base + output->phase;
+    for (uint16_t stn = 0; stn < NUM_STATIONS; stn++, pixel += 3, threshold += DITHER_STATION_STEP) {
+      uint16_t r = frame[stn][0];
+      uint16_t g = frame[stn][1];
+      uint16_t b = frame[stn][2];
+      if (weight != 256) {
+        r = blend(fadeLevels[stn][0], r, weight);
+        g = blend(fadeLevels[stn][1], g, weight);
+        b = blend(fadeLevels[stn][2], b, weight);
+      }
+      if (output->calibration != NULL) {
+        const uint8_t *calibration = output->calibration[stn];
+        r = calibrate(r, pgm_read_byte(&calibration[0]));
+        g = calibrate(g, pgm_read_byte(&calibration[1]));
+        b = calibrate(b, pgm_read_byte(&calibration[2]));
+      }
+      pixel[PIXEL_R] = dither(r, threshold);
+      pixel[PIXEL_G] = dither(g, threshold);
+      pixel[PIXEL_B] = dither(b, threshold);
+      fractions |= (uint8_t) (r | g | b);
+    }
+  }
+  fractional = fractions != 0;
+  // Displays chained on one strip are sent together
+  for (uint8_t i = 0; i < outputCount; i++) {
+    Adafruit_NeoPixel *strip = outputs[i].strip;
+    bool sent = false;
+    for (uint8_t j = 0; j < i && !sent; j++) sent = outputs[j].strip == strip;
+    if (!sent) strip->show();
+  }
 }
@@ -1,6 +1,36 @@
 // Interface for interacting with the LEDs on the physical line diagram.
 // This class can account for things such as automatic gamma correction,
 // tweaking the brightness of individual pixels if necessary, etc.
+// Gamma correction and the global brightness are applied at 16 bit precision
+// (8 bits of output level and 8 bits of fraction), into a frame buffer kept
+// by the diagram. The strip's own brightness setting is not used (it would
+// scale and quantize every pixel a second time).
+//
+// At low brightness many input levels map to the same output level, so fades
+// band. The fraction is kept instead of being rounded away: each time the
+// frame is sent, every channel is bumped up a level if its fraction is above
+// a threshold that changes with every send (ordered temporal dithering). The
+// thresholds go through all 256 values in a spread out order, and are offset
+// per station so neighbouring LEDs don't step together. Averaged over a few
+// sends the LED shows the exact level. While any channel has a fraction the
+// frame needs to be sent again regularly even if nothing changed (refresh(),
+// see scheduler.h), much faster than the animation frame rate so it doesn't
+// flicker.
+//
+// One diagram can drive several displays (outputs), each a run of
+// NUM_STATIONS LEDs on a strip: on its own pin, or chained after another
+// display on the same strip. Every output shows the same frame, so the modes
+// render once and each extra strip only costs its show(). Each output has
+// its own colour calibration, and a dithering phase so that displays next to
+// each other don't dither in step. Every send updates all of the strips'
+// LEDs, so the more displays there are, the further apart the dithering
+// refreshes have to be (sendDisplays()).
+//
+// crossfade() keeps a copy of what is being shown (at 8 bits per channel)
+// and blends from it into the frames that follow, eased over a power of two
+// ms. The blend is applied as the frame is sent, so whatever is shown next
+// only renders its own frames. The frame counts as changed until the fade
+// is over, so it keeps being sent.
 
 #ifndef _MKIII_DIAGRAM_H
 #define _MKIII_DIAGRAM_H
@@ -9,14 +39,98 @@
 #include "stations.h"
 #include "utils.h"
 
+// Define MKIII_RENDER_STATS to count pixel writes and strip updates. This is
+// meant for benchmarking the mode renderers (e.g. off-device with stand-in
+// libraries) and costs nothing when left undefined.
+#ifdef MKIII_RENDER_STATS
+typedef struct RenderStats {
+  uint32_t pixelWrites = 0;
+  uint32_t shows = 0;
+  uint32_t refreshes = 0;
+} RenderStats;
+#endif
+
+#define MAX_DIAGRAM_OUTPUTS 3
+
+// Per-station colour calibration for the first display: the red, green and
+// blue scale of each station's LED, out of 255.
+extern const uint8_t STATION_CALIBRATION[NUM_STATIONS][3] PROGMEM;
+
+typedef struct DiagramOutput {
+  Adafruit_NeoPixel *strip;
+  // LED on the strip where this display's stations start
+  uint16_t offset;
+  // Per-station calibration in PROGMEM (as STATION_CALIBRATION), or NULL
+  const uint8_t (*calibration)[3];
+  // Added to the dithering thresholds
+  uint8_t phase;
+} DiagramOutput;
+
 class LineDiagram {
   public:
+    // The first output's strip
     Adafruit_NeoPixel *strip;
     
     LineDiagram(Adafruit_NeoPixel *strip);
+    // Add another display. Returns false if there is no room for more, or
+    // the strip is too short. The pixel data is written directly, so the
+    // strip must be RGB with 3 bytes per pixel in NEO_GRB order (NEO_GRB +
+    // NEO_KHZ800, as the WS2812), like the first one.
+    bool addOutput(Adafruit_NeoPixel *strip, uint16_t offset, const uint8_t (*calibration)[3], uint8_t phase);
+    // Set the global brightness (max = 255)
+    void setBrightness(uint8_t brightness);
     // Set the color for the particular station number
     void set(uint16_t stn, uint32_t color, bool gamma = true);
-    
+    // Start a new frame where every station not set afterwards is off
+    void clear();
+    // True if the frame differs from the one last sent to the strip
+    bool changed();
+    // Send the frame to the strip, only if it changed. Returns true if sent.
+    bool commit();
+    // Send the current frame to the strip unconditionally
+    void show();
+    // True if the frame needs refreshing to show its fractional levels
+    bool dithering();
+    // Send the frame again, with the next step of dithering
+    void refresh();
+    // How many displays' worth of LEDs each send updates: the length of all
+    // the strips, in NUM_STATIONS, rounded up
+    uint8_t sendDisplays();
+    // Fade from what is shown now into the frames that follow, over 2^bits
+    // ms (bits from 1 to 15, 0 to stop fading)
+    void crossfade(uint8_t bits);
+    // True while a crossfade is in progress
+    bool fading();
+#ifdef MKIII_RENDER_STATS
+    RenderStats stats;
+#endif
+
+  private:
+    uint8_t brightness;
+    // Output level of each channel (red, green, blue), 8.8 fixed point
+    uint16_t frame[NUM_STATIONS][3];
+    DiagramOutput outputs[MAX_DIAGRAM_OUTPUTS];
+    uint8_t outputCount = 0;
+    uint8_t displays = 0;
+    // Counts sends, to step the dithering thresholds
+    uint8_t sends = 0;
+    // Whether the last frame sent had fractional levels
+    bool fractional = false;
+    // Dither the frame into each output's pixel data and send it
+    void send();
+    // Crossfade: the levels faded from, when it started and its length
+    uint8_t fadeLevels[NUM_STATIONS][3];
+    unsigned long fadeStart;
+    uint8_t fadeBits = 0;
+    // How far the crossfade is, out of 256
+    uint16_t fadeWeight();
+    // Whether any pixel differs from what was last sent
+    bool dirty = true;
+    // Set by clear(): stations not touched by set() are turned off when the
+    // frame is committed. This way a station that is cleared and set back to
+    // the same colour doesn't count as a change.
+    bool clearPending = false;
+    uint8_t touched[BITSET_BYTES(NUM_STATIONS)];
 };
 
 #endif
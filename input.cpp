@@ -0,0 +1,59 @@
+#include "input.h"
+#include "ir_codes.h"
+
+#define INPUT_MASK (INPUT_QUEUE_SIZE - 1)
+
+// Steps per repeat while a key is held: none until it has been held for
+// ~0.3 s, then faster after ~1.3 s and ~2.6 s.
+#define REPEAT_DELAY 3
+#define REPEAT_FAST 12
+#define REPEAT_FASTER 24
+
+// Keeps the compiler from moving slot accesses past the index updates
+#define BARRIER() __asm__ __volatile__("" : : : "memory")
+
+bool input_push(InputQueue *queue, unsigned long value, unsigned long time) {
+  if (value == KEY_REPEAT) {
+    if (queue->lastKey == 0 || time - queue->lastTime > INPUT_REPEAT_TIMEOUT) {
+      queue->lastKey = 0;
+      return false;
+    }
+    if (queue->repeats < 255) queue->repeats++;
+  } else {
+    queue->lastKey = value;
+    queue->repeats = 0;
+  }
+  queue->lastTime = time;
+  uint8_t head = queue->head;
+  if ((uint8_t) (head - queue->tail) == INPUT_QUEUE_SIZE) {
+    queue->overflows++;
+    return false;
+  }
+  InputEvent *event = &queue->events[head & INPUT_MASK];
+  event->key = queue->lastKey;
+  event->repeats = queue->repeats;
+  // Only published once the slot is written
+  BARRIER();
+  queue->head = head + 1;
+  return true;
+}
+
+bool input_pop(InputQueue *queue, InputEvent *event) {
+  uint8_t tail = queue->tail;
+  if (tail == queue->head) return false;
+  BARRIER();
+  *event = queue->events[tail & INPUT_MASK];
+  // The slot can be reused once it has been copied
+  BARRIER();
+  queue->tail = tail + 1;
+  return true;
+}
+
+uint8_t input_steps(const InputEvent *event) {
+  uint8_t repeats = event->repeats;
+  if (repeats == 0) return 1;
+  if (repeats < REPEAT_DELAY) return 0;
+  if (repeats < REPEAT_FAST) return 1;
+  if (repeats < REPEAT_FASTER) return 2;
+  return 4;
+}
@@ -0,0 +1,54 @@
+// Remote key presses, queued between the code that decodes them and the
+// code that handles them.
+// The queue is a fixed size ring with one producer and one consumer, and
+// needs no locking: the producer only writes head and the consumer only
+// writes tail, each after it is done with the slot, and both are single
+// bytes (atomic on AVR). So the producer could equally be an interrupt.
+// IRremote decodes outside of its interrupt, so the sketch pushes each
+// command after decode() returns it, and handlers pop them.
+//
+// NEC remotes send KEY_REPEAT (about every 110 ms) while a key is held
+// instead of the key again. The queue turns these back into the held key,
+// with a count of how many times it has repeated, so handlers see the key
+// itself and can step faster the longer it is held (input_steps()). A repeat
+// that comes long after the last key (its press was missed) is dropped.
+
+#ifndef _MKIII_INPUT_H
+#define _MKIII_INPUT_H
+
+#include <stdint.h>
+
+// Must be a power of two
+#define INPUT_QUEUE_SIZE 8
+// Repeats further apart than this (ms) don't belong to the last key
+#define INPUT_REPEAT_TIMEOUT 250
+
+typedef struct InputEvent {
+  unsigned long key;
+  // 0 when the key was pressed, then 1, 2, ... while it is held (255 at most)
+  uint8_t repeats;
+} InputEvent;
+
+typedef struct InputQueue {
+  InputEvent events[INPUT_QUEUE_SIZE];
+  volatile uint8_t head = 0;
+  volatile uint8_t tail = 0;
+  // Producer side, for repeats
+  unsigned long lastKey = 0;
+  unsigned long lastTime = 0;
+  uint8_t repeats = 0;
+  // Events that were dropped because the queue was full
+  uint16_t overflows = 0;
+} InputQueue;
+
+// Producer: queues a decoded command, received at time (millis()).
+// Returns false if it was dropped.
+bool input_push(InputQueue *queue, unsigned long value, unsigned long time);
+// Consumer: takes the oldest event. Returns false if there is none.
+bool input_pop(InputQueue *queue, InputEvent *event);
+// How many steps a key should move by for this event: one when it is
+// pressed, none for the first few repeats (so a press doesn't step twice),
+// then more per repeat the longer it is held.
+uint8_t input_steps(const InputEvent *event);
+
+#endif
@@ -3,41 +3,62 @@
 #include "modes.h"
 #include "stations.h"
 #include "diagram.h"
+#include "colors.h"
+#include "curves.h"
+
+ModeSettings modeSettings;
+ModeState modeState;
+#ifdef __AVR__
+static_assert(sizeof(ModeState) <= MODE_STATE_MAX, "A mode's state is over its budget (see modes.h)");
+#endif
 
 // -------------------------- Mode 0 --------------------------
 // Randomly picks some station LEDs to fade in/out red.
-// Only supports up to the first 64 station LEDs.
+// Every station fades on its own 4 s cycle, offset by a random phase, and
+// decides at the (dark) end of each cycle whether it will light up next.
 // https://youtu.be/amxVBWTSp2o?t=136
 
-Mode0 mode0;
+// The cycle is 4096 ms, so the position in it is just the low bits of millis().
+#define MODE0_CYCLE_BITS 12
+#define MODE0_CYCLE_MASK ((1 << MODE0_CYCLE_BITS) - 1)
+// Coming back to this mode after this long starts over.
+#define MODE0_RESET_TIME 100
 
 void mode0_render(LineDiagram *diagram) {
-  const unsigned long animationTime = 4000;
-  const unsigned long halfAniTime = animationTime / 2;
-  long timeDiff = millis() - mode0.lastTime;
-  Adafruit_NeoPixel *strip = diagram->strip;
-  if (timeDiff >= animationTime) {
-    mode0.lastTime = millis();
-    uint64_t lightPositions = 0L;
-    lightPositions |= (Entropy.random() & 0xFFFFFFFF);
-    lightPositions <<= 32;
-    lightPositions |= (Entropy.random() & 0xFFFFFFFF);
-    mode0.lightPositions = lightPositions;
-    strip->clear();
-  } else {
-    int16_t red = timeDiff > halfAniTime ? map(timeDiff - halfAniTime, 0, halfAniTime, 255, 0) : map(timeDiff, 0, halfAniTime, 0, 255);
-    uint32_t newColor = rgb32((uint8_t) red, 0, 0);
-    for (int i = 0; i < min(NUM_STATIONS, 64); i++) {
-      if (((mode0.lightPositions >> i) & 1) == 1) {
-        diagram->set(i, newColor);
-      }
+  unsigned long ms = millis();
+  uint16_t phase = ms & MODE0_CYCLE_MASK;
+  if (modeState.mode0.lastTime == 0 || ms - modeState.mode0.lastTime > MODE0_RESET_TIME) {
+    diagram->clear();
+    for (int i = 0; i < NUM_STATIONS; i++) {
+      modeState.mode0.offsets[i] = random(0, 256);
+      if (random(0, 2)) bitsetSet(modeState.mode0.lit, i);
+      else bitsetClear(modeState.mode0.lit, i);
+    }
+    modeState.mode0.lastPhase = phase;
+  }
+  modeState.mode0.lastTime = ms;
+
+  for (int i = 0; i < NUM_STATIONS; i++) {
+    uint16_t offset = (uint16_t) modeState.mode0.offsets[i] << (MODE0_CYCLE_BITS - 8);
+    uint16_t position = (phase + offset) & MODE0_CYCLE_MASK;
+    bool lit = bitsetGet(modeState.mode0.lit, i);
+    if (position < ((modeState.mode0.lastPhase + offset) & MODE0_CYCLE_MASK)) {
+      // Started a new cycle
+      if (lit) diagram->set(i, 0);
+      lit = random(0, 2);
+      if (lit) bitsetSet(modeState.mode0.lit, i);
+      else bitsetClear(modeState.mode0.lit, i);
     }
+    // The level moves by 2-3 steps every frame, so lit stations are set
+    // every frame, and set() only marks the frame dirty if one changed.
+    if (lit) diagram->set(i, rgb32(curve(CURVE_TRIANGLE, position << (16 - MODE0_CYCLE_BITS)), 0, 0));
   }
+  modeState.mode0.lastPhase = phase;
 }
 
 void mode0_renderStatic(LineDiagram *diagram) {
   uint32_t red = rgb32(130, 0, 0);
-  for (int i = 0; i < min(NUM_STATIONS, 64); i += 2) {
+  for (int i = 0; i < NUM_STATIONS; i += 2) {
     diagram->set(i, red);
   }
 }
@@ -48,12 +69,10 @@ void mode0_renderStatic(LineDiagram *diagram) {
 // Submode 0 - Sets all LEDs to #7F7F7F.
 // Submode 1 - Sets all stations to their appropriate line colours.
 
-Mode1 mode1;
-
 void mode1_render(LineDiagram *diagram) {
   Adafruit_NeoPixel *strip = diagram->strip;
-  strip->clear();
-  switch (mode1.submode) {
+  diagram->clear();
+  switch (modeSettings.mode1Submode) {
     case 0: {
       uint32_t color = rgb32(127, 127, 127);
       for (int i = 0; i < strip->numPixels(); i++) {
@@ -63,7 +82,7 @@ void mode1_render(LineDiagram *diagram) {
     }
     case 1: {
       for (int i = 0; i < NUM_STATIONS; i++) {
-        diagram->set(i, (i < 20 || i == STN_BRAID || i == STN_SAPPERTON) ? c_expo : c_mill);
+        diagram->set(i, stationColor(i));
       }
       break;
     }
@@ -77,40 +96,51 @@ void mode1_render(LineDiagram *diagram) {
 // Submode 2 - Patterned strobing ("rave").
 // Submode 3 - Red and green slow flashing pattern.
 // Submode 4 - Red and green slow alternating pattern ("xmas").
+// Each submode runs on a cycle of a power of two ms, kept in a Phase.
+
+#define MODE2_RAINBOW_BITS 12 // 4096 ms
+// The strobe's cycle is 32 steps of 256 ms: 4 colours for 4 steps each,
+// 4 for 2 steps each, then 8 for a step each.
+#define MODE2_STROBE_BITS  13
+#define MODE2_STROBE_STEP  11
+#define MODE2_FLASH_BITS   11 // 2048 ms, red then green
 
-Mode2 mode2;
+static uint8_t mode2_periodBits() {
+  switch (modeSettings.mode2Submode) {
+    case 0: return MODE2_RAINBOW_BITS;
+    case 1: return MODE2_STROBE_BITS;
+    default: return MODE2_FLASH_BITS;
+  }
+}
 
-void mode2_render(LineDiagram *diagram, unsigned long ms) {
+void mode2_render(LineDiagram *diagram, uint16_t phase) {
   Adafruit_NeoPixel *strip = diagram->strip;
-  const uint16_t num = strip->numPixels();
-  strip->clear();
-  switch (mode2.submode) {
+  diagram->clear();
+  switch (modeSettings.mode2Submode) {
     case 0: {
-      const uint16_t cycle = map(ms % 5000, 0, 5000, 0, 65535);
-      for (int i = 0; i < num; i++) {
-        diagram->set(i, strip->ColorHSV(65536 / num * (num - i - 1) + cycle));
-      }
+      const uint16_t step = 65536 / NUM_STATIONS;
+      hueGradient(diagram, 0, NUM_STATIONS, phase + step * (NUM_STATIONS - 1), -step);
       break;
     }
     case 1: {
-      uint8_t cycle = (ms / 250 % 32);
-      if (cycle < 16) cycle /= 4;
-      else if (cycle >= 16 && cycle < 24) cycle = (cycle - 16) / 2;
+      uint8_t cycle = phase >> MODE2_STROBE_STEP;
+      if (cycle < 16) cycle >>= 2;
+      else if (cycle < 24) cycle = (cycle - 16) >> 1;
       else cycle = cycle - 24;
-      if (cycle != mode2.lastCycle) {
+      if (cycle != modeState.mode2.lastCycle) {
         if (cycle == 0)
           mode2_shuffle();
-        mode2.lastCycle = cycle;
+        modeState.mode2.lastCycle = cycle;
       }
       const uint16_t num = strip->numPixels();
-      const uint32_t strobe = strip->ColorHSV(65536 / MODE2_PATTERN * mode2.pattern[cycle]);
+      const uint32_t strobe = hueColor(65536 / MODE2_PATTERN * modeState.mode2.pattern[cycle]);
       for (int i = 0; i < num; i++) {
         diagram->set(i, strobe);
       }
       break;
     }
     case 2: {
-      uint8_t cycle = (ms / 1000 % 2);
+      uint8_t cycle = phase >> 15;
       const uint32_t colours[2] = {0xFF0000, 0x00FF00};
       const uint16_t num = strip->numPixels();
       for (int i = 0; i < num; i++) {
@@ -119,7 +149,7 @@ void mode2_render(LineDiagram *diagram, unsigned long ms) {
       break;
     }
     case 3: {
-      uint8_t cycle = (ms / 1000 % 2);
+      uint8_t cycle = phase >> 15;
       const uint32_t colours[2] = {0xFF0000, 0x00FF00};
       const uint16_t num = strip->numPixels();
       for (int i = 0; i < num; i++) {
@@ -130,61 +160,104 @@ void mode2_render(LineDiagram *diagram, unsigned long ms) {
   }
 }
 void mode2_render(LineDiagram *diagram) {
-  mode2_render(diagram, millis());
+  mode2_render(diagram, phase_advance(&modeState.mode2.phase, millis(), mode2_periodBits()));
+}
+bool mode2_wake(unsigned long *time) {
+  Phase *phase = &modeState.mode2.phase;
+  switch (modeSettings.mode2Submode) {
+    case 0:
+      *time = phase->lastTime;
+      break;
+    case 1:
+      *time = phase_nextStep(phase, MODE2_STROBE_STEP, MODE2_STROBE_BITS);
+      break;
+    default:
+      *time = phase_nextStep(phase, 15, MODE2_FLASH_BITS);
+      break;
+  }
+  return true;
 }
 void mode2_renderStatic(LineDiagram *diagram) {
-  switch (mode2.submode) {
+  switch (modeSettings.mode2Submode) {
     case 1:
       for (int i = 0; i < NUM_STATIONS; i++) {
-        diagram->set(i, diagram->strip->ColorHSV(65535 / 13 * (i / 3)));
+        diagram->set(i, hueColor(65535 / 13 * (i / 3)));
       }
       break;
     default:
-      mode2_render(diagram, 500);
+      mode2_render(diagram, 8000);
       break;
   }
 }
+void mode2_enter() {
+  phase_start(&modeState.mode2.phase, millis());
+  mode2_shuffle();
+}
 void mode2_shuffle() {
   // Fisher-Yates shuffle
   for (uint8_t i = 0; i < MODE2_PATTERN; i++) {
     uint8_t j = (uint8_t) random(0, i + 1);
     if (j != i)
-      mode2.pattern[i] = mode2.pattern[j];
-    mode2.pattern[j] = i;
+      modeState.mode2.pattern[i] = modeState.mode2.pattern[j];
+    modeState.mode2.pattern[j] = i;
   }
 }
 
 
 // -------------------------- Mode 3 --------------------------
-// Random line diagram. A random path will be picked
-// and "travelled" to.
+// Submode 0 - Random line diagram. A random path will be picked
+//             and "travelled" to.
+// Submode 1 - Trains running the Expo and Millennium Lines (see trains.h).
 
-Mode3 mode3;
+void mode3_enter() {
+  if (modeSettings.mode3Submode == 1) trains_begin(&modeState.mode3Trains);
+}
 
 void mode3_render(LineDiagram *diagram) {
-  StationPath *route = &(mode3.route);
+  if (modeSettings.mode3Submode == 1) {
+    trains_render(&modeState.mode3Trains, diagram);
+    return;
+  }
+  Route *route = &(modeState.mode3.route);
   if (route->size == 0) {
     // Regenerate the route
-    uint8_t first, second;
+    station_t first, second;
     while (route->size == 0) {
       first = random(0, NUM_STATIONS);
       do {
         second = random(0, NUM_STATIONS);
       } while (second == first);
-      pathfind(route, first, second);
+      routeFind(route, first, second);
     }
-    mode3.originalSize = route->size;
-    mode3.lastTime = millis();
+    modeState.mode3.originalSize = route->size;
+    modeState.mode3.lastTime = millis();
   }
   // Display path
-  diagram->strip->clear();
-  for (int i = 0; i < route->size; i++) {
-    diagram->set(route->path[i], i == 0 ? c_stn_red : c_stn_green);
+  diagram->clear();
+  for (int i = 0; i < NUM_STATIONS; i++) {
+    if (routeContains(route, i)) diagram->set(i, i == route->head ? c_stn_red : c_stn_green);
+  }
+  modeState.mode3.stale = false;
+  if (millis() - modeState.mode3.lastTime > 750) {
+    modeState.mode3.lastTime = millis();
+    routeDropTail(route);
+    modeState.mode3.stale = true;
   }
-  if (millis() - mode3.lastTime > 750) {
-    mode3.lastTime = millis();
-    route->size--;
+}
+
+bool mode3_wake(unsigned long *time) {
+  if (modeSettings.mode3Submode == 1) {
+    return trains_wake(&modeState.mode3Trains, time);
+  } else if (modeState.mode3.stale) {
+    *time = millis();
+  } else {
+    *time = modeState.mode3.lastTime + 751;
   }
+  return true;
+}
+
+void mode3_resume() {
+  if (modeSettings.mode3Submode == 1) trains_resume(&modeState.mode3Trains);
 }
 
 void mode3_renderStatic(LineDiagram *diagram) {
@@ -202,22 +275,25 @@ void mode3_renderStatic(LineDiagram *diagram) {
 // -------------------------- Mode 4 --------------------------
 // Custom line diagram. Set your own static path.
 
-Mode4 mode4;
+void mode4_enter() {
+  routeFind(&modeState.mode4.route, modeSettings.mode4Start, modeSettings.mode4End);
+}
 
 void mode4_render(LineDiagram *diagram) {
   mode4_render(diagram, false);
 }
 
 void mode4_render(LineDiagram *diagram, bool editMode) {
-  diagram->strip->clear();
-  StationPath *route = &mode4.route;
+  diagram->clear();
+  Route *route = &modeState.mode4.route;
   if (route->size == 0) {
     // Path is invalid so highlight orange/purple
-    diagram->set(mode4.start, c_stn_orange);
-    diagram->set(mode4.end, c_stn_purple);
+    diagram->set(modeSettings.mode4Start, c_stn_orange);
+    diagram->set(modeSettings.mode4End, c_stn_purple);
   } else {
-    for (int i = 0; i < route->size; i++) {
-      diagram->set(route->path[i], i == 0 ? c_stn_red : (!editMode || i == route->size - 1 ? c_stn_green : c_stn_yellow));
+    for (int i = 0; i < NUM_STATIONS; i++) {
+      if (!routeContains(route, i)) continue;
+      diagram->set(i, i == route->head ? c_stn_red : (!editMode || i == route->tail ? c_stn_green : c_stn_yellow));
     }
   }
 }
@@ -235,19 +311,17 @@ void mode4_renderStatic(LineDiagram *diagram) {
 // -------------------------- Mode 5 --------------------------
 // Custom static colour.
 
-Mode5 mode5;
-
 void mode5_render(LineDiagram *diagram) {
   mode5_render(diagram, false, false);
 }
 
 void mode5_render(LineDiagram *diagram, bool editMode, bool noSteps) {
-  diagram->strip->clear();
+  diagram->clear();
   if (editMode) {
-    uint32_t red = (uint32_t) mode5.red << 16;
-    uint32_t green = (uint32_t) mode5.green << 8;
-    uint32_t blue = (uint32_t) mode5.blue;
-    uint8_t steps = mode5.steps;
+    uint32_t red = (uint32_t) modeSettings.mode5Red << 16;
+    uint32_t green = (uint32_t) modeSettings.mode5Green << 8;
+    uint32_t blue = (uint32_t) modeSettings.mode5Blue;
+    uint8_t steps = modeState.mode5.steps;
     uint8_t substep = steps % 3;
     uint8_t stepComponent = steps / 3;
    
@@ -261,7 +335,7 @@ void mode5_render(LineDiagram *diagram, bool editMode, bool noSteps) {
     if (!noSteps) {
       // Renfrew to Lake City Way is the least sig. 7 bits of the current component
       uint32_t compColor = stepComponent == 0 ? 0xFF0000 : (stepComponent == 1 ? 0x00FF00 : 0x0000FF);
-      uint8_t currentComp = stepComponent == 0 ? mode5.red : (stepComponent == 1 ? mode5.green : mode5.blue);
+      uint8_t currentComp = stepComponent == 0 ? modeSettings.mode5Red : (stepComponent == 1 ? modeSettings.mode5Green : modeSettings.mode5Blue);
       for (int i = 0; i < 7; i++) {
         if ((currentComp >> i) & 1 == 1) {
           diagram->set(STN_LAKE_CITY_WAY + i, compColor);
@@ -283,7 +357,7 @@ void mode5_render(LineDiagram *diagram, bool editMode, bool noSteps) {
       diagram->set(i, mixed);
     }
   } else {
-    uint32_t color = ((uint32_t) mode5.red << 16) | ((uint32_t) mode5.green << 8) | (mode5.blue);
+    uint32_t color = ((uint32_t) modeSettings.mode5Red << 16) | ((uint32_t) modeSettings.mode5Green << 8) | (modeSettings.mode5Blue);
     for (int i = 0; i < diagram->strip->numPixels(); i++) {
         diagram->set(i, color);
     }
@@ -291,17 +365,78 @@ void mode5_render(LineDiagram *diagram, bool editMode, bool noSteps) {
 }
 
 void mode5_renderStatic(LineDiagram *diagram) {
-  uint8_t oldRed = mode5.red;
-  uint8_t oldGreen = mode5.green;
-  uint8_t oldBlue = mode5.blue;
-  mode5.red = mode5.green = mode5.blue = 255;
+  uint8_t oldRed = modeSettings.mode5Red;
+  uint8_t oldGreen = modeSettings.mode5Green;
+  uint8_t oldBlue = modeSettings.mode5Blue;
+  modeSettings.mode5Red = modeSettings.mode5Green = modeSettings.mode5Blue = 255;
   
   mode5_render(diagram, true, true);
   uint32_t mixed = ((uint32_t) oldRed << 16) | ((uint32_t) oldGreen << 8) | oldBlue;
   diagram->set(STN_BRAID, mixed);
   diagram->set(STN_SAPPERTON, mixed);
   
-  mode5.red = oldRed;
-  mode5.green = oldGreen;
-  mode5.blue = oldBlue;
+  modeSettings.mode5Red = oldRed;
+  modeSettings.mode5Green = oldGreen;
+  modeSettings.mode5Blue = oldBlue;
+}
+
+
+// -------------------------- Mode 6 --------------------------
+// Frames streamed from a host over Serial (see stream.h). The frames are set
+// into the diagram as they arrive, so there is nothing to render.
+
+void mode6_render(LineDiagram *) {
+}
+
+void mode6_renderStatic(LineDiagram *diagram) {
+  for (int i = 0; i < NUM_STATIONS; i += 3) {
+    diagram->set(i, c_cl);
+  }
+}
+
+
+// -------------------------- Registry --------------------------
+
+const RenderMode RENDER_MODES[NUM_RENDER_MODES] PROGMEM = {
+  {NULL, mode0_render, mode0_renderStatic, NULL, NULL},
+  {NULL, mode1_render, mode1_render, mode_static, NULL},
+  {mode2_enter, mode2_render, mode2_renderStatic, mode2_wake, NULL},
+  {mode3_enter, mode3_render, mode3_renderStatic, mode3_wake, mode3_resume},
+  {mode4_enter, mode4_render, mode4_renderStatic, mode_static, NULL},
+  {NULL, mode5_render, mode5_renderStatic, mode_static, NULL},
+  {NULL, mode6_render, mode6_renderStatic, mode_static, NULL},
+};
+
+void mode_enter(uint8_t mode) {
+  memset(&modeState, 0, sizeof(modeState));
+  void (*enter)() = (void (*)()) pgm_read_ptr(&RENDER_MODES[mode].enter);
+  if (enter != NULL) enter();
+}
+
+void mode_render(uint8_t mode, LineDiagram *diagram) {
+  void (*render)(LineDiagram *) = (void (*)(LineDiagram *)) pgm_read_ptr(&RENDER_MODES[mode].render);
+  render(diagram);
+}
+
+void mode_renderStatic(uint8_t mode, LineDiagram *diagram) {
+  void (*renderStatic)(LineDiagram *) = (void (*)(LineDiagram *)) pgm_read_ptr(&RENDER_MODES[mode].renderStatic);
+  renderStatic(diagram);
+}
+
+bool mode_wake(uint8_t mode, unsigned long *time) {
+  bool (*wake)(unsigned long *) = (bool (*)(unsigned long *)) pgm_read_ptr(&RENDER_MODES[mode].wake);
+  if (wake == NULL) {
+    *time = millis();
+    return true;
+  }
+  return wake(time);
+}
+
+void mode_resume(uint8_t mode) {
+  void (*resume)() = (void (*)()) pgm_read_ptr(&RENDER_MODES[mode].resume);
+  if (resume != NULL) resume();
+}
+
+bool mode_static(unsigned long *) {
+  return false;
 }
@@ -9,72 +9,144 @@
 #include <Adafruit_NeoPixel.h>
 #include "diagram.h"
 #include "stations.h"
+#include "utils.h"
+#include "stream.h"
+#include "trains.h"
+#include "curves.h"
 
-#define NUM_RENDER_MODES 6
+#define NUM_RENDER_MODES 7
+#define MODE_STREAM 6
 #define MODE2_PATTERN 16
 
+// Settings that are kept while other modes are shown.
+typedef struct ModeSettings {
+  uint8_t mode1Submode = 0;
+  uint8_t mode2Submode = 0;
+  uint8_t mode3Submode = 0;
+  // Mode 4 route endpoints
+  station_t mode4Start = STN_VCC_CLARK;
+  station_t mode4End = STN_LAFARGE;
+  // Mode 5 colour
+  uint8_t mode5Red = 255;
+  uint8_t mode5Green = 255;
+  uint8_t mode5Blue = 255;
+} ModeSettings;
+extern ModeSettings modeSettings;
+
+// Working state of each mode. Only the current mode has state, so the modes
+// share the same memory (modeState). It is zeroed when a mode is entered,
+// then the mode's enter function sets up anything else it needs.
+// modeState is as large as the largest mode, so it has a budget (checked
+// when building for AVR): a mode that needs more should shrink its state or
+// keep tables in flash instead.
+#define MODE_STATE_MAX 208
+
 typedef struct Mode0 {
-  unsigned long lastTime = 99999;
-  uint64_t lightPositions = 0L;
+  unsigned long lastTime;
+  uint16_t lastPhase;
+  // Which stations are lit this cycle, and where each is in its cycle.
+  uint8_t lit[BITSET_BYTES(NUM_STATIONS)];
+  uint8_t offsets[NUM_STATIONS];
 } Mode0;
-extern Mode0 mode0;
 
 void mode0_render(LineDiagram *diagram);
 void mode0_renderStatic(LineDiagram *diagram);
 
-typedef struct Mode1 {
-  uint8_t submode = 0;
-} Mode1;
-extern Mode1 mode1;
 
 void mode1_render(LineDiagram *diagram);
 
 
 typedef struct Mode2 {
-  uint8_t submode = 0;
-  uint8_t lastCycle = 0;
+  Phase phase;
+  uint8_t lastCycle;
   uint8_t pattern[MODE2_PATTERN];
 } Mode2;
-extern Mode2 mode2;
 
+void mode2_enter();
 void mode2_render(LineDiagram *diagram);
 void mode2_renderStatic(LineDiagram *diagram);
+bool mode2_wake(unsigned long *time);
 void mode2_shuffle();
 
 
 typedef struct Mode3 {
-  StationPath route;
-  uint8_t originalSize = 0;
-  unsigned long lastTime = 0L;
+  Route route;
+  station_t originalSize;
+  unsigned long lastTime;
+  // The route changed since it was displayed
+  bool stale;
 } Mode3;
-extern Mode3 mode3;
 
+void mode3_enter();
 void mode3_render(LineDiagram *diagram);
 void mode3_renderStatic(LineDiagram *diagram);
+bool mode3_wake(unsigned long *time);
+void mode3_resume();
 
 
 typedef struct Mode4 {
-  StationPath route;
-  uint8_t start = STN_VCC_CLARK;
-  uint8_t end = STN_LAFARGE;
+  Route route;
 } Mode4;
-extern Mode4 mode4;
 
+void mode4_enter();
 void mode4_render(LineDiagram *diagram);
 void mode4_render(LineDiagram *diagram, bool editMode);
 void mode4_renderStatic(LineDiagram *diagram);
 
 
 typedef struct Mode5 {
-  uint8_t red = 255;
-  uint8_t green = 255;
-  uint8_t blue = 255;
-  uint8_t steps = 0;
+  uint8_t steps;
 } Mode5;
-extern Mode5 mode5;
 
 void mode5_render(LineDiagram *diagram);
 void mode5_render(LineDiagram *diagram, bool editMode, bool noSteps);
 void mode5_renderStatic(LineDiagram *diagram);
 
+
+typedef struct Mode6 {
+  StreamDecoder decoder;
+} Mode6;
+
+void mode6_render(LineDiagram *diagram);
+void mode6_renderStatic(LineDiagram *diagram);
+
+
+typedef union ModeState {
+  Mode0 mode0;
+  Mode2 mode2;
+  Mode3 mode3;
+  TrainSim mode3Trains;
+  Mode4 mode4;
+  Mode5 mode5;
+  Mode6 mode6;
+} ModeState;
+extern ModeState modeState;
+
+// Each mode's functions, in PROGMEM. enter may be NULL.
+// Modes that are already static use render for renderStatic.
+// wake is called after a frame is rendered: it sets *time to the millis()
+// at which the mode's output next changes, or returns false if it only
+// changes on input (static modes use mode_static). The display can idle
+// until then (see scheduler.h). NULL means the output changes every frame.
+// resume is called before the mode is rendered again after something else
+// was shown (a menu, the editor, an animation or sleep), for modes that
+// only draw what changed. May be NULL.
+typedef struct RenderMode {
+  void (*enter)();
+  void (*render)(LineDiagram *diagram);
+  void (*renderStatic)(LineDiagram *diagram);
+  bool (*wake)(unsigned long *time);
+  void (*resume)();
+} RenderMode;
+extern const RenderMode RENDER_MODES[NUM_RENDER_MODES] PROGMEM;
+
+// Resets the shared state for the mode and enters it.
+void mode_enter(uint8_t mode);
+void mode_render(uint8_t mode, LineDiagram *diagram);
+void mode_renderStatic(uint8_t mode, LineDiagram *diagram);
+// When the mode's output next changes, as its wake function.
+bool mode_wake(uint8_t mode, unsigned long *time);
+void mode_resume(uint8_t mode);
+bool mode_static(unsigned long *time);
+
 #endif
@@ -0,0 +1,55 @@
+#include <Arduino.h>
+#include "profile.h"
+
+#ifdef MKIII_PROFILE
+
+ProbeStats probes[NUM_PROBES];
+
+// Names of the probes after the modes' (which print as "mode" and their number)
+const char PROBE_NAME_PATHFIND[] PROGMEM = "pathfind";
+const char PROBE_NAME_SHOW[] PROGMEM = "show";
+const char PROBE_NAME_HUE_COLOR[] PROGMEM = "hueColor";
+const char* const PROBE_NAMES[NUM_PROBES - PROBE_PATHFIND] PROGMEM = {
+  PROBE_NAME_PATHFIND, PROBE_NAME_SHOW, PROBE_NAME_HUE_COLOR
+};
+
+void profileRecord(uint8_t probe, unsigned long time) {
+  ProbeStats *stats = &probes[probe];
+  if (stats->count == 0xFFFF) return; // Full until printed
+  uint8_t bucket = 0;
+  while (bucket < PROFILE_BUCKETS - 1 && (time >> (bucket + 1)) != 0) bucket++;
+  stats->buckets[bucket]++;
+  stats->count++;
+  stats->totalTime += time;
+  if (time > stats->maxTime) stats->maxTime = time > 0xFFFF ? 0xFFFF : time;
+}
+
+// One line per probe that was hit:
+// name count avg max | bucket counts...
+void profilePrint() {
+  for (uint8_t i = 0; i < NUM_PROBES; i++) {
+    ProbeStats *stats = &probes[i];
+    if (stats->count == 0) continue;
+    if (i < PROBE_PATHFIND) {
+      Serial.print(F("mode"));
+      Serial.print(i - PROBE_MODE_0);
+    } else {
+      Serial.print((const __FlashStringHelper *) pgm_read_ptr(&PROBE_NAMES[i - PROBE_PATHFIND]));
+    }
+    Serial.print(' ');
+    Serial.print(stats->count);
+    Serial.print(' ');
+    Serial.print(stats->totalTime / stats->count);
+    Serial.print(' ');
+    Serial.print(stats->maxTime);
+    Serial.print(F(" |"));
+    for (uint8_t j = 0; j < PROFILE_BUCKETS; j++) {
+      Serial.print(' ');
+      Serial.print(stats->buckets[j]);
+    }
+    Serial.println();
+    *stats = ProbeStats();
+  }
+}
+
+#endif
@@ -0,0 +1,60 @@
+// Timing of the render hot paths.
+// Define MKIII_PROFILE to time each mode's render, pathfinding, colour
+// conversion and strip updates. Each probe keeps a call count, total and
+// maximum time, and a histogram with power-of-two buckets (in us). The
+// results are printed over Serial with the 'p' command.
+// Without MKIII_PROFILE the probes compile to nothing.
+
+#ifndef _MKIII_PROFILE_H
+#define _MKIII_PROFILE_H
+
+#include <Arduino.h>
+#include "modes.h"
+
+#define PROBE_MODE_0    0 // One per render mode, in order
+#define PROBE_PATHFIND  (PROBE_MODE_0 + NUM_RENDER_MODES)
+#define PROBE_SHOW      (PROBE_PATHFIND + 1)
+#define PROBE_HUE_COLOR (PROBE_PATHFIND + 2)
+#define NUM_PROBES      (PROBE_PATHFIND + 3)
+
+// Bucket i counts times from 2^i to 2^(i+1) - 1 us (bucket 0 also counts 0),
+// the last bucket counts everything longer.
+#define PROFILE_BUCKETS 12
+
+#ifdef MKIII_PROFILE
+
+typedef struct ProbeStats {
+  uint16_t count = 0;
+  uint16_t maxTime = 0;
+  uint32_t totalTime = 0;
+  uint16_t buckets[PROFILE_BUCKETS] = {0};
+} ProbeStats;
+
+void profileRecord(uint8_t probe, unsigned long time);
+// Print all probes to Serial and reset them
+void profilePrint();
+
+// Times the rest of the enclosing block
+class ProfileScope {
+  public:
+    ProfileScope(uint8_t probe) {
+      this->probe = probe;
+      start = micros();
+    }
+    ~ProfileScope() {
+      profileRecord(probe, micros() - start);
+    }
+  private:
+    uint8_t probe;
+    unsigned long start;
+};
+
+#define PROFILE_SCOPE(probe) ProfileScope profileScope(probe)
+
+#else
+
+#define PROFILE_SCOPE(probe)
+
+#endif
+
+#endif
@@ -0,0 +1,160 @@
+#include <IRremote.h>
+#include "scheduler.h"
+#include "diagram.h"
+#ifdef __AVR__
+#include <avr/sleep.h>
+#endif
+
+// Edges that never turn into a decoded command (noise, other remotes) are
+// forgotten after this long.
+#define IR_EDGE_TIMEOUT 250000UL
+
+// Time of the first receiver edge since the last decoded command, 0 if none.
+static volatile unsigned long firstEdgeMicros = 0;
+
+static void onReceiverEdge() {
+  if (firstEdgeMicros == 0) firstEdgeMicros = micros() | 1;
+}
+
+#ifdef __AVR__
+// An interrupt that comes between checking for something to do and going to
+// sleep isn't missed for long: the millis() timer wakes the CPU every ~1 ms,
+// and IRremote's timer every 50 us.
+void idleCpu() {
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  sleep_enable();
+  sleep_cpu();
+  sleep_disable();
+}
+#endif
+
+FrameScheduler::FrameScheduler(LineDiagram *diagram, IRrecv *irrecv, unsigned long framePeriod, unsigned long refreshPeriod) {
+  this->diagram = diagram;
+  this->irrecv = irrecv;
+  this->framePeriod = framePeriod;
+  this->refreshPeriod = refreshPeriod;
+}
+
+void FrameScheduler::begin(uint8_t irPin) {
+  attachInterrupt(digitalPinToInterrupt(irPin), onReceiverEdge, FALLING);
+  nextFrame = nextRefresh = micros();
+}
+
+bool FrameScheduler::inputPending() {
+  return firstEdgeMicros != 0 || Serial.available() > 0;
+}
+
+// Sleeps until deadline (in micros()), sending dithering refreshes
+// meanwhile. Returns false if it stopped early because of input.
+bool FrameScheduler::waitUntil(unsigned long deadline, bool wakeOnInput) {
+  while (true) {
+    unsigned long now = micros();
+    if ((long) (deadline - now) <= 0) return true;
+    if (wakeOnInput && inputPending()) return false;
+    if (refreshing && refreshPeriod != 0 && !pending && diagram->dithering() && (long) (nextRefresh - now) <= 0) {
+      // Skipped while an IR signal is arriving, like frames
+      if (!receiving()) {
+        diagram->refresh();
+        frameStats.refreshes++;
+      }
+      // Refreshing more displays takes longer, so the share of the time
+      // spent with interrupts off stays the same
+      nextRefresh = now + refreshPeriod * diagram->sendDisplays();
+    } else {
+      idleCpu();
+    }
+  }
+}
+
+void FrameScheduler::waitForFrame() {
+  unsigned long now = micros();
+  if ((long) (nextFrame - now) > 0) {
+    waitUntil(nextFrame, false);
+    now = micros();
+  } else {
+    unsigned long late = now - nextFrame;
+    if (late >= framePeriod) {
+      // Whole frames were missed, skip them instead of catching up.
+      unsigned long missed = late / framePeriod;
+      nextFrame += missed * framePeriod;
+      frameStats.skippedFrames += missed;
+      late -= missed * framePeriod;
+    }
+    if (late > frameStats.maxLateness) frameStats.maxLateness = late;
+  }
+  frameStart = now;
+  nextFrame += framePeriod;
+}
+
+void FrameScheduler::frameDone() {
+  unsigned long time = micros() - frameStart;
+  frameStats.frames++;
+  frameStats.totalTime += time;
+  if (time < frameStats.minTime) frameStats.minTime = time;
+  if (time > frameStats.maxTime) frameStats.maxTime = time;
+  if (time > framePeriod) frameStats.overruns++;
+}
+
+void FrameScheduler::idle(unsigned long ms) {
+  if (ms > SCHEDULER_IDLE_MAX) ms = SCHEDULER_IDLE_MAX;
+  if (ms * 1000 <= framePeriod || inputPending()) return;
+  unsigned long start = micros();
+  unsigned long deadline = start + ms * 1000;
+  bool timedOut = waitUntil(deadline, true);
+  unsigned long now = micros();
+  unsigned long latency = 0;
+  if (timedOut) {
+    latency = now - deadline;
+  } else {
+    noInterrupts();
+    unsigned long firstEdge = firstEdgeMicros;
+    interrupts();
+    if (firstEdge != 0) latency = now - firstEdge;
+  }
+  frameStats.idleTime += (now - start) / 1000;
+  frameStats.wakes++;
+  if (latency > frameStats.maxWakeLatency) frameStats.maxWakeLatency = latency;
+  nextFrame = now;
+}
+
+bool FrameScheduler::receiving() {
+  return !irrecv->isIdle();
+}
+
+void FrameScheduler::show() {
+  if (!diagram->changed()) return;
+  if (receiving()) {
+    pending = true;
+    stats.droppedFrames++;
+    return;
+  }
+  pending = false;
+  diagram->commit();
+}
+
+void FrameScheduler::update() {
+  if (receiving()) return;
+  if (pending) {
+    pending = false;
+    diagram->commit();
+  }
+  noInterrupts();
+  unsigned long firstEdge = firstEdgeMicros;
+  if (firstEdge != 0 && micros() - firstEdge > IR_EDGE_TIMEOUT) firstEdgeMicros = 0;
+  interrupts();
+}
+
+void FrameScheduler::commandDecoded() {
+  noInterrupts();
+  unsigned long firstEdge = firstEdgeMicros;
+  firstEdgeMicros = 0;
+  interrupts();
+  stats.commands++;
+  if (firstEdge == 0) return;
+  stats.lastLatency = micros() - firstEdge;
+  if (stats.lastLatency > stats.maxLatency) stats.maxLatency = stats.lastLatency;
+}
+
+void FrameScheduler::setRefreshing(bool refreshing) {
+  this->refreshing = refreshing;
+}
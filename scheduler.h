@@ -0,0 +1,118 @@
+// Decides when frames are rendered and sent to the LEDs.
+// Frames are scheduled on absolute deadlines, one frame period apart, so the
+// frame rate doesn't depend on how long a mode takes to render. If a frame
+// runs so late that whole deadlines have passed, those frames are skipped
+// (and counted) rather than rendered back to back to catch up.
+//
+// While waiting for the next frame, a frame that is being dithered (see
+// diagram.h) is sent again every refresh period, which is set separately
+// from the frame period. The refresh period is for one display, and is
+// stretched for each further display the diagram sends to.
+//
+// The CPU sleeps (in idle mode, so timers and interrupts keep running)
+// while waiting instead of busy-waiting. After a frame, the loop can also
+// idle for longer when the display won't change for a while (each mode
+// reports when it next changes, see modes.h), waking on the deadline, an IR
+// signal or Serial data. A static mode, IR mode or sleep mode costs a frame
+// every SCHEDULER_IDLE_MAX at most, plus the refreshes if it is dithered.
+//
+// Frames are also timed so that they don't disrupt the IR receiver.
+// Sending data to the strip disables interrupts for ~1.2 ms, but IRremote
+// samples the receiver from a timer interrupt every 50 us while a signal is
+// arriving. Frames are therefore held back while a signal is being received
+// and sent as soon as it has been captured. Edges on the receiver pin are
+// timestamped so that the delay between a key press and its command being
+// handled can be measured.
+
+#ifndef _MKIII_SCHEDULER_H
+#define _MKIII_SCHEDULER_H
+
+#include <IRremote.h>
+#include "diagram.h"
+
+// Longest time idle() waits for, in ms
+#define SCHEDULER_IDLE_MAX 10000
+
+typedef struct SchedulerStats {
+  // Frames that were held back because an IR signal was being received.
+  uint16_t droppedFrames = 0;
+  uint16_t commands = 0;
+  // Time from the first IR edge to the command being decoded, in us.
+  unsigned long lastLatency = 0;
+  unsigned long maxLatency = 0;
+} SchedulerStats;
+
+typedef struct FrameStats {
+  unsigned long frames = 0;
+  // Time spent rendering and sending each frame, in us.
+  unsigned long minTime = 0xFFFFFFFF;
+  unsigned long maxTime = 0;
+  unsigned long totalTime = 0;
+  // How late frames started compared to their deadline, in us.
+  unsigned long maxLateness = 0;
+  // Frames that took longer than the frame period.
+  uint16_t overruns = 0;
+  // Deadlines that passed without a frame being rendered.
+  uint16_t skippedFrames = 0;
+  // Dithering refreshes sent between frames.
+  unsigned long refreshes = 0;
+  // Time spent in idle(), in ms, and how many times it woke up.
+  unsigned long idleTime = 0;
+  uint16_t wakes = 0;
+  // How long after its deadline, or after an IR signal started, idle()
+  // returned, in us.
+  unsigned long maxWakeLatency = 0;
+} FrameStats;
+
+class FrameScheduler {
+  public:
+    SchedulerStats stats;
+    FrameStats frameStats;
+
+    // framePeriod and refreshPeriod are in us. A refreshPeriod of 0 turns
+    // dithering refreshes off.
+    FrameScheduler(LineDiagram *diagram, IRrecv *irrecv, unsigned long framePeriod, unsigned long refreshPeriod);
+    // Start timestamping edges on the IR receiver pin.
+    // The pin must support external interrupts (2 or 3 on the Uno).
+    void begin(uint8_t irPin);
+    // Wait until the next frame is due, refreshing the current one meanwhile.
+    // Call before rendering each frame.
+    void waitForFrame();
+    // Call once the frame has been rendered and shown, to record its timing.
+    void frameDone();
+    // Wait for up to ms (at most SCHEDULER_IDLE_MAX), or until there is
+    // input, refreshing the current frame meanwhile. The next frame is due
+    // as soon as it returns. Does nothing if ms is no longer than a frame.
+    void idle(unsigned long ms);
+    // True while an IR signal is being received
+    bool receiving();
+    // Show the current frame if it changed, or hold it back until it is safe
+    // to send
+    void show();
+    // Call regularly. Sends a held back frame once the IR signal is over.
+    void update();
+    // Call whenever decode() returns a command
+    void commandDecoded();
+    // Turn dithering refreshes off, e.g. while Serial data can arrive at
+    // any time (sending to the strip loses the bytes that arrive meanwhile)
+    void setRefreshing(bool refreshing);
+
+  private:
+    LineDiagram *diagram;
+    IRrecv *irrecv;
+    bool pending = false;
+    bool refreshing = true;
+    unsigned long framePeriod;
+    unsigned long refreshPeriod;
+    unsigned long nextFrame;
+    unsigned long nextRefresh;
+    unsigned long frameStart;
+    bool waitUntil(unsigned long deadline, bool wakeOnInput);
+    bool inputPending();
+};
+
+// Sleeps until the next interrupt. Off-device builds (without avr/sleep.h)
+// must define it, e.g. to advance a virtual clock.
+void idleCpu();
+
+#endif
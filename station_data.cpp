@@ -0,0 +1,302 @@
+// Generated by tools/gen_stations.py from data/stations.csv and
+// data/lines.csv. Do not edit by hand.
+
+#include <avr/pgmspace.h>
+#include "station_data.h"
+
+const char STATION_NAME_0[] PROGMEM = "Waterfront";
+const char STATION_NAME_1[] PROGMEM = "Burrard";
+const char STATION_NAME_2[] PROGMEM = "Granville";
+const char STATION_NAME_3[] PROGMEM = "Stadium-Chinatown";
+const char STATION_NAME_4[] PROGMEM = "Main Street-Science World";
+const char STATION_NAME_5[] PROGMEM = "Broadway";
+const char STATION_NAME_6[] PROGMEM = "Nanaimo";
+const char STATION_NAME_7[] PROGMEM = "29th Avenue";
+const char STATION_NAME_8[] PROGMEM = "Joyce-Collingwood";
+const char STATION_NAME_9[] PROGMEM = "Patterson";
+const char STATION_NAME_10[] PROGMEM = "Metrotown";
+const char STATION_NAME_11[] PROGMEM = "Royal Oak";
+const char STATION_NAME_12[] PROGMEM = "Edmonds";
+const char STATION_NAME_13[] PROGMEM = "22nd Street";
+const char STATION_NAME_14[] PROGMEM = "New Westminster";
+const char STATION_NAME_15[] PROGMEM = "Columbia";
+const char STATION_NAME_16[] PROGMEM = "Scott Road";
+const char STATION_NAME_17[] PROGMEM = "Gateway";
+const char STATION_NAME_18[] PROGMEM = "Surrey Central";
+const char STATION_NAME_19[] PROGMEM = "King George";
+const char STATION_NAME_20[] PROGMEM = "Lafarge Lake-Douglas";
+const char STATION_NAME_21[] PROGMEM = "Lincoln";
+const char STATION_NAME_22[] PROGMEM = "Coquitlam Central";
+const char STATION_NAME_23[] PROGMEM = "Inlet Centre";
+const char STATION_NAME_24[] PROGMEM = "Moody Centre";
+const char STATION_NAME_25[] PROGMEM = "Burquitlam";
+const char STATION_NAME_26[] PROGMEM = "Braid";
+const char STATION_NAME_27[] PROGMEM = "Sapperton";
+const char STATION_NAME_28[] PROGMEM = "Lougheed Town Centre";
+const char STATION_NAME_29[] PROGMEM = "Production Way-University";
+const char STATION_NAME_30[] PROGMEM = "Lake City Way";
+const char STATION_NAME_31[] PROGMEM = "Sperling-Burnaby Lake";
+const char STATION_NAME_32[] PROGMEM = "Holdom";
+const char STATION_NAME_33[] PROGMEM = "Brentwood Town Centre";
+const char STATION_NAME_34[] PROGMEM = "Gilmore";
+const char STATION_NAME_35[] PROGMEM = "Rupert";
+const char STATION_NAME_36[] PROGMEM = "Renfrew";
+const char STATION_NAME_37[] PROGMEM = "Commercial";
+const char STATION_NAME_38[] PROGMEM = "VCC-Clark";
+const char* const STATION_NAMES[NUM_STATIONS] PROGMEM = {
+  STATION_NAME_0,
+  STATION_NAME_1,
+  STATION_NAME_2,
+  STATION_NAME_3,
+  STATION_NAME_4,
+  STATION_NAME_5,
+  STATION_NAME_6,
+  STATION_NAME_7,
+  STATION_NAME_8,
+  STATION_NAME_9,
+  STATION_NAME_10,
+  STATION_NAME_11,
+  STATION_NAME_12,
+  STATION_NAME_13,
+  STATION_NAME_14,
+  STATION_NAME_15,
+  STATION_NAME_16,
+  STATION_NAME_17,
+  STATION_NAME_18,
+  STATION_NAME_19,
+  STATION_NAME_20,
+  STATION_NAME_21,
+  STATION_NAME_22,
+  STATION_NAME_23,
+  STATION_NAME_24,
+  STATION_NAME_25,
+  STATION_NAME_26,
+  STATION_NAME_27,
+  STATION_NAME_28,
+  STATION_NAME_29,
+  STATION_NAME_30,
+  STATION_NAME_31,
+  STATION_NAME_32,
+  STATION_NAME_33,
+  STATION_NAME_34,
+  STATION_NAME_35,
+  STATION_NAME_36,
+  STATION_NAME_37,
+  STATION_NAME_38,
+};
+
+const station_t STATION_X[NUM_STATIONS] PROGMEM = {
+  0, // STN_WATERFRONT
+  1, // STN_BURRARD
+  2, // STN_GRANVILLE
+  3, // STN_STADIUM
+  5, // STN_MAIN_STREET
+  6, // STN_BROADWAY
+  8, // STN_NANAIMO
+  10, // STN_29TH_AVENUE
+  12, // STN_JOYCE
+  14, // STN_PATTERSON
+  16, // STN_METROTOWN
+  18, // STN_ROYAL_OAK
+  20, // STN_EDMONDS
+  22, // STN_22ND_STREET
+  24, // STN_NEW_WESTMINSTER
+  26, // STN_COLUMBIA
+  30, // STN_SCOTT_ROAD
+  32, // STN_GATEWAY
+  34, // STN_SURREY_CENTRAL
+  36, // STN_KING_GEORGE
+  38, // STN_LAFARGE
+  37, // STN_LINCOLN
+  35, // STN_COQUITLAM_CENTRAL
+  33, // STN_INLET_CENTRE
+  31, // STN_MOODY_CENTRE
+  27, // STN_BURQUITLAM
+  28, // STN_BRAID
+  29, // STN_SAPPERTON
+  25, // STN_LOUGHEED
+  23, // STN_PRODUCTION
+  21, // STN_LAKE_CITY_WAY
+  19, // STN_SPERLING
+  17, // STN_HOLDOM
+  15, // STN_BRENTWOOD
+  13, // STN_GILMORE
+  11, // STN_RUPERT
+  9, // STN_RENFREW
+  7, // STN_COMMERCIAL
+  4, // STN_VCC_CLARK
+};
+
+const station_t STATION_X_ORDER[NUM_STATIONS] PROGMEM = {
+  STN_WATERFRONT,
+  STN_BURRARD,
+  STN_GRANVILLE,
+  STN_STADIUM,
+  STN_VCC_CLARK,
+  STN_MAIN_STREET,
+  STN_BROADWAY,
+  STN_COMMERCIAL,
+  STN_NANAIMO,
+  STN_RENFREW,
+  STN_29TH_AVENUE,
+  STN_RUPERT,
+  STN_JOYCE,
+  STN_GILMORE,
+  STN_PATTERSON,
+  STN_BRENTWOOD,
+  STN_METROTOWN,
+  STN_HOLDOM,
+  STN_ROYAL_OAK,
+  STN_SPERLING,
+  STN_EDMONDS,
+  STN_LAKE_CITY_WAY,
+  STN_22ND_STREET,
+  STN_PRODUCTION,
+  STN_NEW_WESTMINSTER,
+  STN_LOUGHEED,
+  STN_COLUMBIA,
+  STN_BURQUITLAM,
+  STN_BRAID,
+  STN_SAPPERTON,
+  STN_SCOTT_ROAD,
+  STN_MOODY_CENTRE,
+  STN_GATEWAY,
+  STN_INLET_CENTRE,
+  STN_SURREY_CENTRAL,
+  STN_COQUITLAM_CENTRAL,
+  STN_KING_GEORGE,
+  STN_LINCOLN,
+  STN_LAFARGE,
+};
+
+const uint8_t STATION_LINES[NUM_STATIONS] PROGMEM = {
+  LINE_EXPO, // STN_WATERFRONT
+  LINE_EXPO, // STN_BURRARD
+  LINE_EXPO, // STN_GRANVILLE
+  LINE_EXPO, // STN_STADIUM
+  LINE_EXPO, // STN_MAIN_STREET
+  LINE_EXPO, // STN_BROADWAY
+  LINE_EXPO, // STN_NANAIMO
+  LINE_EXPO, // STN_29TH_AVENUE
+  LINE_EXPO, // STN_JOYCE
+  LINE_EXPO, // STN_PATTERSON
+  LINE_EXPO, // STN_METROTOWN
+  LINE_EXPO, // STN_ROYAL_OAK
+  LINE_EXPO, // STN_EDMONDS
+  LINE_EXPO, // STN_22ND_STREET
+  LINE_EXPO, // STN_NEW_WESTMINSTER
+  LINE_EXPO, // STN_COLUMBIA
+  LINE_EXPO, // STN_SCOTT_ROAD
+  LINE_EXPO, // STN_GATEWAY
+  LINE_EXPO, // STN_SURREY_CENTRAL
+  LINE_EXPO, // STN_KING_GEORGE
+  LINE_MILL, // STN_LAFARGE
+  LINE_MILL, // STN_LINCOLN
+  LINE_MILL, // STN_COQUITLAM_CENTRAL
+  LINE_MILL, // STN_INLET_CENTRE
+  LINE_MILL, // STN_MOODY_CENTRE
+  LINE_MILL, // STN_BURQUITLAM
+  LINE_EXPO, // STN_BRAID
+  LINE_EXPO, // STN_SAPPERTON
+  LINE_MILL | LINE_EXPO, // STN_LOUGHEED
+  LINE_MILL | LINE_EXPO, // STN_PRODUCTION
+  LINE_MILL, // STN_LAKE_CITY_WAY
+  LINE_MILL, // STN_SPERLING
+  LINE_MILL, // STN_HOLDOM
+  LINE_MILL, // STN_BRENTWOOD
+  LINE_MILL, // STN_GILMORE
+  LINE_MILL, // STN_RUPERT
+  LINE_MILL, // STN_RENFREW
+  LINE_MILL, // STN_COMMERCIAL
+  LINE_MILL, // STN_VCC_CLARK
+};
+
+// Index of the line giving each station its colour
+const uint8_t STATION_COLOR_LINE[NUM_STATIONS] PROGMEM = {
+  0, // STN_WATERFRONT
+  0, // STN_BURRARD
+  0, // STN_GRANVILLE
+  0, // STN_STADIUM
+  0, // STN_MAIN_STREET
+  0, // STN_BROADWAY
+  0, // STN_NANAIMO
+  0, // STN_29TH_AVENUE
+  0, // STN_JOYCE
+  0, // STN_PATTERSON
+  0, // STN_METROTOWN
+  0, // STN_ROYAL_OAK
+  0, // STN_EDMONDS
+  0, // STN_22ND_STREET
+  0, // STN_NEW_WESTMINSTER
+  0, // STN_COLUMBIA
+  0, // STN_SCOTT_ROAD
+  0, // STN_GATEWAY
+  0, // STN_SURREY_CENTRAL
+  0, // STN_KING_GEORGE
+  1, // STN_LAFARGE
+  1, // STN_LINCOLN
+  1, // STN_COQUITLAM_CENTRAL
+  1, // STN_INLET_CENTRE
+  1, // STN_MOODY_CENTRE
+  1, // STN_BURQUITLAM
+  0, // STN_BRAID
+  0, // STN_SAPPERTON
+  1, // STN_LOUGHEED
+  1, // STN_PRODUCTION
+  1, // STN_LAKE_CITY_WAY
+  1, // STN_SPERLING
+  1, // STN_HOLDOM
+  1, // STN_BRENTWOOD
+  1, // STN_GILMORE
+  1, // STN_RUPERT
+  1, // STN_RENFREW
+  1, // STN_COMMERCIAL
+  1, // STN_VCC_CLARK
+};
+
+const station_t STATION_LINKS[NUM_STATIONS][MAX_STATION_LINKS] PROGMEM = {
+  {STN_BURRARD, NO_STATION, NO_STATION}, // STN_WATERFRONT
+  {STN_WATERFRONT, STN_GRANVILLE, NO_STATION}, // STN_BURRARD
+  {STN_BURRARD, STN_STADIUM, NO_STATION}, // STN_GRANVILLE
+  {STN_GRANVILLE, STN_MAIN_STREET, NO_STATION}, // STN_STADIUM
+  {STN_STADIUM, STN_BROADWAY, NO_STATION}, // STN_MAIN_STREET
+  {STN_MAIN_STREET, STN_NANAIMO, NO_STATION}, // STN_BROADWAY
+  {STN_BROADWAY, STN_29TH_AVENUE, NO_STATION}, // STN_NANAIMO
+  {STN_NANAIMO, STN_JOYCE, NO_STATION}, // STN_29TH_AVENUE
+  {STN_29TH_AVENUE, STN_PATTERSON, NO_STATION}, // STN_JOYCE
+  {STN_JOYCE, STN_METROTOWN, NO_STATION}, // STN_PATTERSON
+  {STN_PATTERSON, STN_ROYAL_OAK, NO_STATION}, // STN_METROTOWN
+  {STN_METROTOWN, STN_EDMONDS, NO_STATION}, // STN_ROYAL_OAK
+  {STN_ROYAL_OAK, STN_22ND_STREET, NO_STATION}, // STN_EDMONDS
+  {STN_EDMONDS, STN_NEW_WESTMINSTER, NO_STATION}, // STN_22ND_STREET
+  {STN_22ND_STREET, STN_COLUMBIA, NO_STATION}, // STN_NEW_WESTMINSTER
+  {STN_NEW_WESTMINSTER, STN_SCOTT_ROAD, STN_SAPPERTON}, // STN_COLUMBIA
+  {STN_COLUMBIA, STN_GATEWAY, NO_STATION}, // STN_SCOTT_ROAD
+  {STN_SCOTT_ROAD, STN_SURREY_CENTRAL, NO_STATION}, // STN_GATEWAY
+  {STN_GATEWAY, STN_KING_GEORGE, NO_STATION}, // STN_SURREY_CENTRAL
+  {STN_SURREY_CENTRAL, NO_STATION, NO_STATION}, // STN_KING_GEORGE
+  {STN_LINCOLN, NO_STATION, NO_STATION}, // STN_LAFARGE
+  {STN_LAFARGE, STN_COQUITLAM_CENTRAL, NO_STATION}, // STN_LINCOLN
+  {STN_LINCOLN, STN_INLET_CENTRE, NO_STATION}, // STN_COQUITLAM_CENTRAL
+  {STN_COQUITLAM_CENTRAL, STN_MOODY_CENTRE, NO_STATION}, // STN_INLET_CENTRE
+  {STN_INLET_CENTRE, STN_BURQUITLAM, NO_STATION}, // STN_MOODY_CENTRE
+  {STN_MOODY_CENTRE, STN_LOUGHEED, NO_STATION}, // STN_BURQUITLAM
+  {STN_SAPPERTON, STN_LOUGHEED, NO_STATION}, // STN_BRAID
+  {STN_COLUMBIA, STN_BRAID, NO_STATION}, // STN_SAPPERTON
+  {STN_BURQUITLAM, STN_BRAID, STN_PRODUCTION}, // STN_LOUGHEED
+  {STN_LOUGHEED, STN_LAKE_CITY_WAY, NO_STATION}, // STN_PRODUCTION
+  {STN_PRODUCTION, STN_SPERLING, NO_STATION}, // STN_LAKE_CITY_WAY
+  {STN_LAKE_CITY_WAY, STN_HOLDOM, NO_STATION}, // STN_SPERLING
+  {STN_SPERLING, STN_BRENTWOOD, NO_STATION}, // STN_HOLDOM
+  {STN_HOLDOM, STN_GILMORE, NO_STATION}, // STN_BRENTWOOD
+  {STN_BRENTWOOD, STN_RUPERT, NO_STATION}, // STN_GILMORE
+  {STN_GILMORE, STN_RENFREW, NO_STATION}, // STN_RUPERT
+  {STN_RUPERT, STN_COMMERCIAL, NO_STATION}, // STN_RENFREW
+  {STN_RENFREW, STN_VCC_CLARK, NO_STATION}, // STN_COMMERCIAL
+  {STN_COMMERCIAL, NO_STATION, NO_STATION}, // STN_VCC_CLARK
+};
+
+const uint8_t LINE_COLORS[NUM_LINES][3] PROGMEM = {
+  {30, 89, 174}, // LINE_EXPO
+  {252, 208, 6}, // LINE_MILL
+};
@@ -0,0 +1,73 @@
+// Generated by tools/gen_stations.py from data/stations.csv and
+// data/lines.csv. Do not edit by hand.
+
+#ifndef _MKIII_STATION_DATA_H
+#define _MKIII_STATION_DATA_H
+
+#include <stdint.h>
+
+#define NUM_STATIONS 39
+#define MAX_STATION_LINKS 3
+#define NUM_LINES 2
+
+// Station IDs are one byte wide unless the network outgrows it.
+#if NUM_STATIONS < 255
+typedef uint8_t station_t;
+#else
+typedef uint16_t station_t;
+#endif
+
+#define STN_WATERFRONT        0
+#define STN_BURRARD           1
+#define STN_GRANVILLE         2
+#define STN_STADIUM           3
+#define STN_MAIN_STREET       4
+#define STN_BROADWAY          5
+#define STN_NANAIMO           6
+#define STN_29TH_AVENUE       7
+#define STN_JOYCE             8
+#define STN_PATTERSON         9
+#define STN_METROTOWN         10
+#define STN_ROYAL_OAK         11
+#define STN_EDMONDS           12
+#define STN_22ND_STREET       13
+#define STN_NEW_WESTMINSTER   14
+#define STN_COLUMBIA          15
+#define STN_SCOTT_ROAD        16
+#define STN_GATEWAY           17
+#define STN_SURREY_CENTRAL    18
+#define STN_KING_GEORGE       19
+#define STN_LAFARGE           20
+#define STN_LINCOLN           21
+#define STN_COQUITLAM_CENTRAL 22
+#define STN_INLET_CENTRE      23
+#define STN_MOODY_CENTRE      24
+#define STN_BURQUITLAM        25
+#define STN_BRAID             26
+#define STN_SAPPERTON         27
+#define STN_LOUGHEED          28
+#define STN_PRODUCTION        29
+#define STN_LAKE_CITY_WAY     30
+#define STN_SPERLING          31
+#define STN_HOLDOM            32
+#define STN_BRENTWOOD         33
+#define STN_GILMORE           34
+#define STN_RUPERT            35
+#define STN_RENFREW           36
+#define STN_COMMERCIAL        37
+#define STN_VCC_CLARK         38
+
+#define NO_STATION            ((station_t) ~0)
+
+#define LINE_EXPO (1 << 0)
+#define LINE_MILL (1 << 1)
+
+extern const char* const STATION_NAMES[NUM_STATIONS];
+extern const station_t STATION_X[NUM_STATIONS];
+extern const station_t STATION_X_ORDER[NUM_STATIONS];
+extern const uint8_t STATION_LINES[NUM_STATIONS];
+extern const uint8_t STATION_COLOR_LINE[NUM_STATIONS];
+extern const station_t STATION_LINKS[NUM_STATIONS][MAX_STATION_LINKS];
+extern const uint8_t LINE_COLORS[NUM_LINES][3];
+
+#endif
@@ -1,155 +1,169 @@
 #include <stdint.h>
-#include "stations.h"
 #include <string.h>
+#include <avr/pgmspace.h>
+#include "stations.h"
+#include "utils.h"
+#include "profile.h"
+
+// The network is described as data: the generated station table lists the
+// stations each one is directly connected to, and the "no through route" table
+// lists the turns a train cannot make without reversing (the wyes at Columbia
+// and Lougheed). Adding stations or lines only needs these tables to be
+// updated.
+
+// A route may not pass through the middle station going between the other
+// two, in either direction.
+//
+// routeFind() marks stations as visited, not (previous station, station)
+// pairs, so each station is only ever reached once. That is only exact
+// because the network is a tree (plus the two wyes, which are single
+// stations): there is one way to reach each station, so one that is
+// reached in a direction where a wye blocks the way on can't be reached in
+// another direction either. Adding a loop to the network (two lines joining
+// again) would need the search to go over (previous, station) states
+// instead, as the reference search in tools/routecheck does, and routes to
+// record which way they go where they could go more than one way (Route
+// relies on there being only one).
+#define NUM_NO_THROUGH_ROUTES 2
+const station_t NO_THROUGH_ROUTES[NUM_NO_THROUGH_ROUTES][3] PROGMEM = {
+  {STN_SCOTT_ROAD, STN_COLUMBIA, STN_SAPPERTON},
+  {STN_BURQUITLAM, STN_LOUGHEED, STN_BRAID}
+};
+
+static station_t readStation(const station_t *ptr) {
+  if (sizeof(station_t) == 1) return pgm_read_byte(ptr);
+  return pgm_read_word(ptr);
+}
 
+station_t stationLink(station_t stn, uint8_t slot) {
+  return readStation(&STATION_LINKS[stn][slot]);
+}
+
+const __FlashStringHelper* stationName(station_t stn) {
+  return (const __FlashStringHelper *) pgm_read_ptr(&STATION_NAMES[stn]);
+}
+
+station_t stationX(station_t stn) {
+  return readStation(&STATION_X[stn]);
+}
 
-StationPath* pathfindDirectional(StationPath *path, uint8_t from, uint8_t to, int8_t direction) {
-  path->size = 0;
-  
-  if (direction != 1 && direction != -1) return path;
-  if (direction == -1 && (from == STN_WATERFRONT || from == STN_LAFARGE)) return path;
-  if (direction == 1 && (from == STN_VCC_CLARK || from == STN_KING_GEORGE)) return path;
-  if (from == to) {
-    path->path[path->size++] = from;
-    return path;
+station_t stationAtX(station_t x) {
+  return readStation(&STATION_X_ORDER[x]);
+}
+
+uint8_t stationLines(station_t stn) {
+  return pgm_read_byte(&STATION_LINES[stn]);
+}
+
+uint32_t stationColor(station_t stn) {
+  const uint8_t *color = LINE_COLORS[pgm_read_byte(&STATION_COLOR_LINE[stn])];
+  return rgb32(pgm_read_byte(&color[0]), pgm_read_byte(&color[1]), pgm_read_byte(&color[2]));
+}
+
+static bool isThroughRoute(station_t a, station_t via, station_t b) {
+  for (uint8_t i = 0; i < NUM_NO_THROUGH_ROUTES; i++) {
+    if (readStation(&NO_THROUGH_ROUTES[i][1]) != via) continue;
+    station_t x = readStation(&NO_THROUGH_ROUTES[i][0]);
+    station_t y = readStation(&NO_THROUGH_ROUTES[i][2]);
+    if ((a == x && b == y) || (a == y && b == x)) return false;
   }
+  return true;
+}
 
-  uint8_t current = from;
-  
-  do {
-    path->path[path->size++] = current;
-    if (current == to) { // This station is the endpoint, finish the path.
-      break;
-    }
-    if (current == STN_COLUMBIA) {
-      // Split at Columbia.
-      StationPath leftRight;
-      memset(leftRight.path, 0, NUM_STATIONS);
-      if (path->size < 2 || path->path[path->size - 2] != STN_SAPPERTON) pathfindDirectional(&leftRight, STN_SCOTT_ROAD, to, 1);
-      if (leftRight.size == 0 && (path->size < 2 || path->path[path->size - 2] != STN_NEW_WESTMINSTER)) pathfindDirectional(&leftRight, STN_NEW_WESTMINSTER, to, -1);
-      if (leftRight.size == 0 && path->size >= 2 && path->path[path->size - 2] == STN_SAPPERTON) {
-        // Cannot backtrack onto itself. No path.
-        path->size = 0;
-        return path;
-      }
-      if (leftRight.size == 0) { // Didn't find it on the Expo Line.
-        // Go onto the Sapperton-Braid branch. Manually doing these paths for simplicity.
-        // Can't go onto the path if came from Scott Road.
-        if (path->size >= 2 && path->path[path->size - 2] == STN_SCOTT_ROAD) {
-          path->size = 0;
-          return path;
-        }
-        if (to == STN_SAPPERTON) {
-          path->path[path->size++] = STN_SAPPERTON;
-          return path;
-        } else if (to == STN_BRAID) {
-          path->path[path->size++] = STN_SAPPERTON;
-          path->path[path->size++] = STN_BRAID;
-          return path;
-        } else if (to == STN_LOUGHEED) {
-          path->path[path->size++] = STN_SAPPERTON;
-          path->path[path->size++] = STN_BRAID;
-          path->path[path->size++] = STN_LOUGHEED;
-          return path;
-        } else {
-          // From Lougheed, branch off west (or east).
-          path->path[path->size++] = STN_SAPPERTON;
-          path->path[path->size++] = STN_BRAID;
-          path->path[path->size++] = STN_LOUGHEED;
-          leftRight.size = 0;
-          pathfindDirectional(&leftRight, STN_PRODUCTION, to, 1);
-          if (leftRight.size == 0) { // No path in the end.
-            path->size = 0;
-          } else {
-            for (int i = 0; i < leftRight.size; i++) {
-              path->path[path->size++] = leftRight.path[i];
-            }
-          }
-          return path;
-        }
-      } else {
-        for (int i = 0; i < leftRight.size; i++) {
-          path->path[path->size++] = leftRight.path[i];
-        }
-        return path;
-      }
-    } else if (current == STN_LOUGHEED) {
-      // Split at Lougheed.
-      StationPath leftRight;
-      memset(leftRight.path, 0, NUM_STATIONS);
-      if (path->size < 2 || path->path[path->size - 2] != STN_BRAID) pathfindDirectional(&leftRight, STN_BURQUITLAM, to, -1);
-      if (leftRight.size == 0 && (path->size < 2 || path->path[path->size - 2] != STN_PRODUCTION)) pathfindDirectional(&leftRight, STN_PRODUCTION, to, 1);
-      if (leftRight.size == 0 && path->size >= 2 && path->path[path->size - 2] == STN_BRAID) {
-        // Cannot backtrack onto itself. No path.
-        path->size = 0;
-        return path;
-      }
-      if (leftRight.size == 0) { // Didn't find it on the Millennium Line.
-        // Go onto the Braid-Sapperton branch. Manually doing these paths for simplicity.
-        // Can't go onto the path if came from Burquitlam.
-        if (path->size >= 2 && path->path[path->size - 2] == STN_BURQUITLAM) {
-          path->size = 0;
-          return path;
-        }
-        if (to == STN_BRAID) {
-          path->path[path->size++] = STN_BRAID;
-          return path;
-        } else if (to == STN_SAPPERTON) {
-          path->path[path->size++] = STN_BRAID;
-          path->path[path->size++] = STN_SAPPERTON;
-          return path;
-        } else if (to == STN_COLUMBIA) {
-          path->path[path->size++] = STN_BRAID;
-          path->path[path->size++] = STN_SAPPERTON;
-          path->path[path->size++] = STN_COLUMBIA;
-          return path;
-        } else {
-          // From Columbia, branch off west (or east).
-          path->path[path->size++] = STN_BRAID;
-          path->path[path->size++] = STN_SAPPERTON;
-          path->path[path->size++] = STN_COLUMBIA;
-          leftRight.size = 0;
-          pathfindDirectional(&leftRight, STN_NEW_WESTMINSTER, to, -1);
-          if (leftRight.size == 0) { // No path in the end.
-            path->size = 0;
-          } else {
-            for (int i = 0; i < leftRight.size; i++) {
-              path->path[path->size++] = leftRight.path[i];
-            }
-          }
-          return path;
-        }
-      } else {
-        for (int i = 0; i < leftRight.size; i++) {
-          path->path[path->size++] = leftRight.path[i];
+// Breadth-first search outwards from the start, one hop per level, with
+// each level's frontier kept as a bitset. Every station reached records the
+// previous station towards the start, so once the end is reached the route
+// is read off from its tail. Each station and link is visited at most once,
+// but every level scans the whole frontier bitset for the stations in it, so
+// the cost is O(stations + links + levels * stations / 8), where the levels
+// are the length of the route. With routes up to 29 stations long and 5
+// bytes of bitset here, the scans (at most 145 bytes) cost about as much
+// as visiting the 39 stations and their links.
+Route* routeFind(Route *route, station_t from, station_t to) {
+  PROFILE_SCOPE(PROBE_PATHFIND);
+  route->size = 0;
+  memset(route->stations, 0, sizeof(route->stations));
+  if (from >= NUM_STATIONS || to >= NUM_STATIONS) return route;
+
+  station_t previous[NUM_STATIONS];
+  uint8_t visited[BITSET_BYTES(NUM_STATIONS)];
+  uint8_t frontier[BITSET_BYTES(NUM_STATIONS)];
+  uint8_t reached[BITSET_BYTES(NUM_STATIONS)];
+  memset(visited, 0, sizeof(visited));
+  memset(frontier, 0, sizeof(frontier));
+  bitsetSet(visited, from);
+  bitsetSet(frontier, from);
+  previous[from] = NO_STATION;
+
+  bool growing = true;
+  while (growing && !bitsetGet(visited, to)) {
+    growing = false;
+    memset(reached, 0, sizeof(reached));
+    for (uint16_t i = 0; i < sizeof(frontier); i++) {
+      uint8_t bits = frontier[i];
+      for (station_t current = i << 3; bits != 0; current++, bits >>= 1) {
+        if ((bits & 1) == 0) continue;
+        for (uint8_t slot = 0; slot < MAX_STATION_LINKS; slot++) {
+          station_t link = stationLink(current, slot);
+          if (link == NO_STATION || bitsetGet(visited, link)) continue;
+          if (previous[current] != NO_STATION && !isThroughRoute(link, current, previous[current])) continue;
+          previous[link] = current;
+          bitsetSet(visited, link);
+          bitsetSet(reached, link);
+          growing = true;
         }
-        return path;
       }
-    } else if (current != from && (current == STN_WATERFRONT || current == STN_VCC_CLARK || current == STN_LAFARGE || current == STN_KING_GEORGE)) {
-      // Terminus stations (and this is not the first stn). Didn't find a path.
-      path->size = 0;
-      return path;
     }
+    memcpy(frontier, reached, sizeof(frontier));
+  }
+  if (!bitsetGet(visited, to)) return route; // No route
 
-    if (current == STN_BRAID && direction == -1) {
-      current = STN_LOUGHEED;
-    } else if (current == STN_SAPPERTON && direction == 1) {
-      current = STN_COLUMBIA;
-    } else if (current == STN_BURQUITLAM && direction == 1) {
-      current = STN_LOUGHEED;
-    } else {
-      current += direction;
-    }
-  } while (true);
+  station_t size = 0;
+  for (station_t current = to; current != NO_STATION; current = previous[current]) {
+    bitsetSet(route->stations, current);
+    size++;
+  }
+  route->size = size;
+  route->head = from;
+  route->tail = to;
+  return route;
+}
+
+void routeDropTail(Route *route) {
+  if (route->size == 0) return;
+  bitsetClear(route->stations, route->tail);
+  if (--route->size > 0) route->tail = routeNext(route, route->tail, NO_STATION);
+}
+
+station_t routeNext(const Route *route, station_t stn, station_t previous) {
+  return stationsNext(route->stations, stn, previous);
+}
 
+station_t stationsNext(const uint8_t *stations, station_t stn, station_t previous) {
+  station_t onward = NO_STATION;
+  for (uint8_t slot = 0; slot < MAX_STATION_LINKS; slot++) {
+    station_t link = stationLink(stn, slot);
+    if (link == NO_STATION || link == previous || !bitsetGet(stations, link)) continue;
+    if (onward != NO_STATION) return NO_STATION;
+    onward = link;
+  }
+  return onward;
+}
+
+StationPath* routeDecode(const Route *route, StationPath *path) {
+  path->size = route->size;
+  station_t previous = NO_STATION;
+  station_t current = route->tail;
+  for (station_t i = route->size; i > 0; i--) {
+    path->path[i - 1] = current;
+    station_t next = routeNext(route, current, previous);
+    previous = current;
+    current = next;
+  }
   return path;
 }
 
-StationPath* pathfind(StationPath *path, uint8_t from, uint8_t to) {
-  path->size = 0;
-  memset(path->path, 0, NUM_STATIONS);
-  if (from >= NUM_STATIONS || to >= NUM_STATIONS) return path;
-  pathfindDirectional(path, from, to, 1);
-  if (path->size > 0) return path;
-  return pathfindDirectional(path, from, to, -1);
+StationPath* pathfind(StationPath *path, station_t from, station_t to) {
+  Route route;
+  return routeDecode(routeFind(&route, from, to), path);
 }
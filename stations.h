@@ -1,190 +1,71 @@
 // Defines the stations of the Expo and Millennium Lines of the SkyTrain network.
 // Please note that Commercial-Broadway is split into Broadway and Commercial.
-// Each station is assigned an int ID in their data order.
+// Each station is assigned an int ID in their data order, which is also the
+// order of the LEDs from head to tail. The station table itself is generated
+// from data/stations.csv into station_data.h and station_data.cpp (in flash),
+// and read through the functions below.
 
 #ifndef _MKIII_STATIONS_H
 #define _MKIII_STATIONS_H
 
-#define NUM_STATIONS 39
-
-#define STN_WATERFRONT        0
-#define STN_BURRARD           1
-#define STN_GRANVILLE         2
-#define STN_STADIUM           3
-#define STN_MAIN_STREET       4
-#define STN_BROADWAY          5
-#define STN_NANAIMO           6
-#define STN_29TH_AVENUE       7
-#define STN_JOYCE             8
-#define STN_PATTERSON         9
-#define STN_METROTOWN         10
-#define STN_ROYAL_OAK         11
-#define STN_EDMONDS           12
-#define STN_22ND_STREET       13
-#define STN_NEW_WESTMINSTER   14
-#define STN_COLUMBIA          15
-#define STN_SCOTT_ROAD        16
-#define STN_GATEWAY           17
-#define STN_SURREY_CENTRAL    18
-#define STN_KING_GEORGE       19
-#define STN_LAFARGE           20
-#define STN_LINCOLN           21
-#define STN_COQUITLAM_CENTRAL 22
-#define STN_INLET_CENTRE      23
-#define STN_MOODY_CENTRE      24
-#define STN_BURQUITLAM        25
-#define STN_BRAID             26
-#define STN_SAPPERTON         27
-#define STN_LOUGHEED          28
-#define STN_PRODUCTION        29
-#define STN_LAKE_CITY_WAY     30
-#define STN_SPERLING          31
-#define STN_HOLDOM            32
-#define STN_BRENTWOOD         33
-#define STN_GILMORE           34
-#define STN_RUPERT            35
-#define STN_RENFREW           36
-#define STN_COMMERCIAL        37
-#define STN_VCC_CLARK         38
-
+#include <stdint.h>
+#include "utils.h"
+#include "station_data.h"
 
 typedef struct StationPath {
-  uint8_t size = 0;
-  uint8_t path[NUM_STATIONS];
+  station_t size;
+  station_t path[NUM_STATIONS];
 } StationPath;
 
-// Modifies a station path struct of stations from start to end.
-StationPath* pathfind(StationPath* path, uint8_t from, uint8_t to);
+// A route between two stations, in a fraction of the space of a StationPath.
+// The stations on the route are kept as a bitset, so checking whether a
+// station is on it is a single lookup. The order is kept by walking the
+// route from its tail: the network is a tree (see stations.cpp), so from
+// each station there is only one way on that stays on the route.
+typedef struct Route {
+  station_t size;
+  station_t head; // First station (the start)
+  station_t tail; // Last station (the end)
+  uint8_t stations[BITSET_BYTES(NUM_STATIONS)];
+} Route;
 
-// Below: Defines the LED orderings.
-// The data order is the actual data order of LEDs for each station from head to tail.
-// This is also the same numeric order of the stations as defined in stations.h.
-// The x order is the left-to-right order of LEDs.
+// Finds the shortest route through the network from start to end.
+// The route is empty if there is no route between the two stations.
+Route* routeFind(Route *route, station_t from, station_t to);
+// Removes the last station of the route.
+void routeDropTail(Route *route);
+// The station after stn along the route, coming from previous (NO_STATION to
+// start from an end). Returns NO_STATION at the end of the route, or where
+// the route has more than one way on.
+station_t routeNext(const Route *route, station_t stn, station_t previous);
+// As routeNext(), for a route kept as just the bitset of its stations.
+station_t stationsNext(const uint8_t *stations, station_t stn, station_t previous);
+// Writes out the stations on the route in order, from head to tail.
+StationPath* routeDecode(const Route *route, StationPath *path);
 
-const uint8_t STATION_DATA_ORDER[NUM_STATIONS] = {
-  STN_WATERFRONT,
-  STN_BURRARD,
-  STN_GRANVILLE,
-  STN_STADIUM,
-  STN_MAIN_STREET,
-  STN_BROADWAY,
-  STN_NANAIMO,
-  STN_29TH_AVENUE,
-  STN_JOYCE,
-  STN_PATTERSON,
-  STN_METROTOWN,
-  STN_ROYAL_OAK,
-  STN_EDMONDS,
-  STN_22ND_STREET,
-  STN_NEW_WESTMINSTER,
-  STN_COLUMBIA,
-  STN_SCOTT_ROAD,
-  STN_GATEWAY,
-  STN_SURREY_CENTRAL,
-  STN_KING_GEORGE,
-  STN_LAFARGE,
-  STN_LINCOLN,
-  STN_COQUITLAM_CENTRAL,
-  STN_INLET_CENTRE,
-  STN_MOODY_CENTRE,
-  STN_BURQUITLAM,
-  STN_BRAID,
-  STN_SAPPERTON,
-  STN_LOUGHEED,
-  STN_PRODUCTION,
-  STN_LAKE_CITY_WAY,
-  STN_SPERLING,
-  STN_HOLDOM,
-  STN_BRENTWOOD,
-  STN_GILMORE,
-  STN_RUPERT,
-  STN_RENFREW,
-  STN_COMMERCIAL,
-  STN_VCC_CLARK
-};
+inline bool routeContains(const Route *route, station_t stn) {
+  return bitsetGet(route->stations, stn);
+}
+
+// Modifies a station path struct of stations from start to end.
+// The path is the shortest route through the network, and is empty if there
+// is no route between the two stations.
+StationPath* pathfind(StationPath* path, station_t from, station_t to);
 
-const uint8_t STATION_X_ORDER[NUM_STATIONS] = {
-  STN_WATERFRONT,
-  STN_BURRARD,
-  STN_GRANVILLE,
-  STN_STADIUM,
-  STN_VCC_CLARK,
-  STN_MAIN_STREET,
-  STN_BROADWAY,
-  STN_COMMERCIAL,
-  STN_NANAIMO,
-  STN_RENFREW,
-  STN_29TH_AVENUE,
-  STN_RUPERT,
-  STN_JOYCE,
-  STN_GILMORE,
-  STN_PATTERSON,
-  STN_BRENTWOOD,
-  STN_METROTOWN,
-  STN_HOLDOM,
-  STN_ROYAL_OAK,
-  STN_SPERLING,
-  STN_EDMONDS,
-  STN_LAKE_CITY_WAY,
-  STN_22ND_STREET,
-  STN_PRODUCTION,
-  STN_NEW_WESTMINSTER,
-  STN_LOUGHEED,
-  STN_COLUMBIA,
-  STN_BURQUITLAM,
-  STN_BRAID,
-  STN_SAPPERTON,
-  STN_SCOTT_ROAD,
-  STN_MOODY_CENTRE,
-  STN_GATEWAY,
-  STN_INLET_CENTRE,
-  STN_SURREY_CENTRAL,
-  STN_COQUITLAM_CENTRAL,
-  STN_KING_GEORGE,
-  STN_LINCOLN,
-  STN_LAFARGE
-};
+// Returns the station connected to stn in the given link slot
+// (0 to MAX_STATION_LINKS - 1), or NO_STATION if the slot is unused.
+station_t stationLink(station_t stn, uint8_t slot);
 
-const char* const STN_NAMES[NUM_STATIONS] = {
-  "Waterfront",
-  "Burrard",
-  "Granville",
-  "Stadium-Chinatown",
-  "Main Street-Science World",
-  "Broadway",
-  "Nanaimo",
-  "29th Avenue",
-  "Joyce-Collingwood",
-  "Patterson",
-  "Metrotown",
-  "Royal Oak",
-  "Edmonds",
-  "22nd Street",
-  "New Westminster",
-  "Columbia",
-  "Scott Road",
-  "Gateway",
-  "Surrey Central",
-  "King George",
-  "Lafarge Lake-Douglas",
-  "Lincoln",
-  "Coquitlam Central",
-  "Inlet Centre",
-  "Moody Centre",
-  "Burquitlam",
-  "Braid",
-  "Sapperton",
-  "Lougheed Town Centre",
-  "Production Way-University",
-  "Lake City Way",
-  "Sperling-Burnaby Lake",
-  "Holdom",
-  "Brentwood Town Centre",
-  "Gilmore",
-  "Rupert",
-  "Renfrew",
-  "Commercial",
-  "VCC-Clark"
-};
+// Returns the station's name, which can be printed directly.
+const __FlashStringHelper* stationName(station_t stn);
+// Returns the left-to-right position of the station's LED (0 to
+// NUM_STATIONS - 1, so it has the same type as a station).
+station_t stationX(station_t stn);
+// Returns the station at the given left-to-right position.
+station_t stationAtX(station_t x);
+// Returns the LINE_ flags of the lines serving the station.
+uint8_t stationLines(station_t stn);
+// Returns the colour of the line the station is shown in.
+uint32_t stationColor(station_t stn);
 
 #endif
@@ -0,0 +1,92 @@
+#include <Arduino.h>
+#include "stream.h"
+#include "diagram.h"
+#include "utils.h"
+
+#define STATE_SYNC      0
+#define STATE_LENGTH_LO 1
+#define STATE_LENGTH_HI 2
+#define STATE_DATA      3
+#define STATE_CHECK_A   4
+#define STATE_CHECK_B   5
+
+StreamStats streamStats;
+
+static uint8_t fletcherAdd(uint8_t sum, uint8_t value) {
+  uint16_t total = (uint16_t) sum + value;
+  return total >= 255 ? total - 255 : total;
+}
+
+static void reply(uint8_t value) {
+  Serial.write(value);
+  if (value == STREAM_REPLY_BAD) streamStats.bad++;
+  else if (value == STREAM_REPLY_BUSY) streamStats.busy++;
+}
+
+// Gives up on a packet that stopped arriving
+static void checkTimeout(StreamDecoder *decoder, unsigned long now) {
+  if (decoder->state == STATE_SYNC || now - decoder->lastByte <= STREAM_BYTE_TIMEOUT) return;
+  decoder->state = STATE_SYNC;
+  reply(STREAM_REPLY_BAD);
+}
+
+uint8_t stream_read(StreamDecoder *decoder, LineDiagram *diagram, uint8_t value) {
+  unsigned long now = millis();
+  checkTimeout(decoder, now);
+  decoder->lastByte = now;
+  switch (decoder->state) {
+    case STATE_SYNC:
+      if (value != STREAM_SYNC) return STREAM_COMMAND;
+      decoder->state = STATE_LENGTH_LO;
+      decoder->sumA = decoder->sumB = 0;
+      decoder->position = 0;
+      // The frame being shown must not be overwritten
+      decoder->reply = decoder->showing ? STREAM_REPLY_BUSY : 0;
+      return STREAM_CONSUMED;
+    case STATE_LENGTH_LO:
+      decoder->length = value;
+      decoder->state = STATE_LENGTH_HI;
+      break;
+    case STATE_LENGTH_HI:
+      decoder->length |= (uint16_t) value << 8;
+      if (decoder->reply == 0 && decoder->length != NUM_STATIONS * 3) decoder->reply = STREAM_REPLY_BAD;
+      decoder->state = decoder->length == 0 ? STATE_CHECK_A : STATE_DATA;
+      break;
+    case STATE_DATA:
+      if (decoder->reply == 0) decoder->pixels[decoder->position] = value;
+      if (++decoder->position == decoder->length) decoder->state = STATE_CHECK_A;
+      break;
+    case STATE_CHECK_A:
+      if (value != decoder->sumA && decoder->reply == 0) decoder->reply = STREAM_REPLY_BAD;
+      decoder->state = STATE_CHECK_B;
+      return STREAM_CONSUMED;
+    case STATE_CHECK_B:
+      decoder->state = STATE_SYNC;
+      if (value != decoder->sumB && decoder->reply == 0) decoder->reply = STREAM_REPLY_BAD;
+      if (decoder->reply != 0) {
+        reply(decoder->reply);
+        return STREAM_CONSUMED;
+      }
+      for (uint16_t stn = 0; stn < NUM_STATIONS; stn++) {
+        const uint8_t *pixel = &decoder->pixels[stn * 3];
+        diagram->set(stn, rgb32(pixel[0], pixel[1], pixel[2]));
+      }
+      decoder->showing = true;
+      return STREAM_FRAME;
+  }
+  decoder->sumA = fletcherAdd(decoder->sumA, value);
+  decoder->sumB = fletcherAdd(decoder->sumB, decoder->sumA);
+  return STREAM_CONSUMED;
+}
+
+void stream_update(StreamDecoder *decoder, LineDiagram *diagram) {
+  checkTimeout(decoder, millis());
+  if (!decoder->showing || diagram->changed()) return;
+  decoder->showing = false;
+  streamStats.shown++;
+  reply(STREAM_REPLY_SHOWN);
+}
+
+bool stream_receiving(StreamDecoder *decoder) {
+  return decoder->state != STATE_SYNC;
+}
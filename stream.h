@@ -0,0 +1,82 @@
+// Frames streamed from a host over Serial (Mode 6).
+// The host sends whole frames as packets:
+//   STREAM_SYNC, length low, length high, pixel bytes..., checksum A,
+//   checksum B
+// length is the number of pixel bytes (16 bits, low byte first), 3 per
+// station (red, green, blue) in data order, and must match the diagram. The
+// checksum is a Fletcher-16 sum over the length and pixel bytes. The pixel bytes are collected in the
+// decoder as they arrive, and only once the checksum matches are they set
+// into the diagram's frame, through LineDiagram::set (so gamma, brightness,
+// calibration and dithering still apply). A bad packet leaves the frame
+// as it was.
+//
+// Each packet gets a one byte reply, and the host should wait for it before
+// sending the next packet:
+// - STREAM_REPLY_SHOWN -> The frame was sent to the LEDs.
+// - STREAM_REPLY_BAD   -> Wrong length or checksum, the frame was ignored.
+// - STREAM_REPLY_BUSY  -> The previous frame was still waiting to be shown
+//                         (held back by IR, see scheduler.h). Dropped.
+// The reply to a good frame is only sent once it has been shown, which is
+// the host's backpressure: at 500000 baud a frame takes under 3 ms to send,
+// so a host waiting for replies can keep up 50 fps. Sending while the LEDs
+// are updated would lose bytes, since interrupts are off for that time.
+// Bytes outside of a packet are passed on as Serial commands. A packet
+// that stops for longer than STREAM_BYTE_TIMEOUT (a byte was lost) is
+// abandoned with a STREAM_REPLY_BAD, so it doesn't swallow the next one.
+// tools/stream_frames.py plays recorded frames this way, and
+// tools/streamdevice runs this decoder on Linux behind a pty to test it.
+
+#ifndef _MKIII_STREAM_H
+#define _MKIII_STREAM_H
+
+#include <stdint.h>
+#include "diagram.h"
+
+#define STREAM_BAUD 500000
+// Longest gap between the bytes of a packet, in ms. The host sends a packet
+// in one go, so at 500000 baud its bytes are 20 us apart.
+#define STREAM_BYTE_TIMEOUT 5
+
+#define STREAM_SYNC        0xA5
+#define STREAM_REPLY_SHOWN 'K'
+#define STREAM_REPLY_BAD   'E'
+#define STREAM_REPLY_BUSY  'B'
+
+// What stream_read() did with a byte
+#define STREAM_COMMAND  0 // Not part of a packet
+#define STREAM_CONSUMED 1 // Part of a packet
+#define STREAM_FRAME    2 // Completed a good frame, which should be shown
+
+typedef struct StreamStats {
+  unsigned long shown = 0;
+  uint16_t bad = 0;
+  uint16_t busy = 0;
+} StreamStats;
+extern StreamStats streamStats;
+
+// Packet decoding state. All zero is waiting for a packet.
+typedef struct StreamDecoder {
+  uint8_t state;
+  uint16_t length;
+  uint16_t position;
+  // Fletcher-16 sums so far
+  uint8_t sumA;
+  uint8_t sumB;
+  // Pixel data of the packet, applied once its checksum matches
+  uint8_t pixels[NUM_STATIONS * 3];
+  // When the last byte of the packet arrived
+  unsigned long lastByte;
+  // Reply for a packet that is being skipped, 0 if it is being decoded
+  uint8_t reply;
+  // A good frame is waiting to be shown
+  bool showing;
+} StreamDecoder;
+
+uint8_t stream_read(StreamDecoder *decoder, LineDiagram *diagram, uint8_t value);
+// Call after trying to show a frame, and while a packet is being received.
+// Replies to the host once the frame was shown, or when the packet timed out.
+void stream_update(StreamDecoder *decoder, LineDiagram *diagram);
+// True while a packet is partly received
+bool stream_receiving(StreamDecoder *decoder);
+
+#endif
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+# Generates clip_data.h and clip_data.cpp: pre-rendered animations ("clips")
+# that clip.h plays from flash. Run from anywhere: python3 tools/gen_clips.py
+#
+# A clip is a list of frames, each a colour (red, green, blue) for every
+# station by its left-to-right position on the diagram, shown for 2^bits ms.
+# The clips are defined in CLIPS below, either computed here or loaded from a
+# recording made for tools/stream_frames.py (raw frames in station data
+# order). The format is described in clip.h.
+
+import csv
+import os
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+KEYFRAME = 0xFF
+
+
+def read_stations():
+    with open(os.path.join(ROOT, "data", "stations.csv"), newline="") as f:
+        rows = [line for line in f if line.strip() and not line.startswith("#")]
+    return list(csv.DictReader(rows))
+
+
+STATIONS = read_stations()
+NUM_STATIONS = len(STATIONS)
+
+
+def fail(message):
+    sys.exit("gen_clips: " + message)
+
+
+def color_hsv(hue):
+    # Adafruit_NeoPixel::ColorHSV(hue) at full saturation and value
+    hue = (hue * 1530 + 32768) // 65536
+    if hue < 510:
+        return (255, hue, 0) if hue < 255 else (510 - hue, 255, 0)
+    if hue < 1020:
+        return (0, 255, hue - 510) if hue < 765 else (0, 1020 - hue, 255)
+    if hue < 1530:
+        return (hue - 1020, 0, 255) if hue < 1275 else (255, 0, 1530 - hue)
+    return (255, 0, 0)
+
+
+HUE_WHEEL = [color_hsv(i * 256) for i in range(256)]
+
+
+def hue_color(hue):
+    # The same interpolation as hueColor() in colors.cpp
+    hue &= 0xFFFF
+    a, b = HUE_WHEEL[hue >> 8], HUE_WHEEL[((hue >> 8) + 1) & 0xFF]
+    fraction = hue & 0xFF
+    return tuple(x + (((y - x) * fraction) >> 8) if y >= x else x - (((x - y) * fraction) >> 8)
+                 for x, y in zip(a, b))
+
+
+def wipe():
+    # A rainbow sweeps in from the left, one position per frame, then sweeps
+    # out the same way.
+    step = 65536 // NUM_STATIONS
+    frames = []
+    for s in range(2 * NUM_STATIONS):
+        sweep_out = s >= NUM_STATIONS
+        i = s - NUM_STATIONS if sweep_out else s
+        frame = []
+        for x in range(NUM_STATIONS):
+            lit = x > i if sweep_out else x <= i
+            frame.append(hue_color(step * (x - i)) if lit else (0, 0, 0))
+        frames.append(frame)
+    return frames
+
+
+def recording(path):
+    # Raw frames in station data order, as for tools/stream_frames.py
+    with open(os.path.join(ROOT, path), "rb") as f:
+        data = f.read()
+    size = NUM_STATIONS * 3
+    if len(data) % size != 0:
+        fail(path + " is not a whole number of frames")
+    frames = []
+    for start in range(0, len(data), size):
+        by_station = [tuple(data[start + i * 3:start + i * 3 + 3]) for i in range(NUM_STATIONS)]
+        frame = [None] * NUM_STATIONS
+        for stn, row in enumerate(STATIONS):
+            frame[int(row["x"])] = by_station[stn]
+        frames.append(frame)
+    return frames
+
+
+# name: (frame time bits, frames)
+CLIPS = {
+    "WIPE": (3, wipe),
+}
+
+
+def changed_runs(previous, indices):
+    # Runs of positions that changed, as (start, end). Runs with only a
+    # couple of unchanged positions between them are joined, as a run costs
+    # 2 bytes.
+    runs = []
+    for x in range(NUM_STATIONS):
+        if indices[x] == previous[x]:
+            continue
+        if runs and x - runs[-1][1] <= 2:
+            runs[-1][1] = x + 1
+        else:
+            runs.append([x, x + 1])
+    return runs
+
+
+def encode(frames, bits):
+    palette = []
+    for frame in frames:
+        for color in frame:
+            if color not in palette:
+                palette.append(color)
+    if len(palette) > 255:
+        fail("more than 255 colours")
+    if len(frames) > 0xFFFF:
+        fail("too many frames")
+    data = [len(frames) & 0xFF, len(frames) >> 8, bits, len(palette)]
+    for color in palette:
+        data.extend(color)
+    keyframes = 0
+    previous = None
+    for frame in frames:
+        indices = [palette.index(color) for color in frame]
+        runs = [] if previous is None else changed_runs(previous, indices)
+        delta = [len(runs)]
+        for start, end in runs:
+            delta += [start, end - start] + indices[start:end]
+        # A keyframe when the deltas would take more space
+        if previous is None or len(delta) >= 1 + NUM_STATIONS:
+            data.append(KEYFRAME)
+            data.extend(indices)
+            keyframes += 1
+        else:
+            data.extend(delta)
+        previous = indices
+    return data, len(palette), keyframes
+
+
+def main():
+    if NUM_STATIONS >= KEYFRAME:
+        fail("too many stations for the clip format")
+    header = [
+        "// Generated by tools/gen_clips.py. Do not edit by hand.",
+        "",
+    ]
+    h = header + [
+        "#ifndef _MKIII_CLIP_DATA_H",
+        "#define _MKIII_CLIP_DATA_H",
+        "",
+        "#include <stdint.h>",
+        "#include <avr/pgmspace.h>",
+        "",
+    ]
+    cpp = header + [
+        "#include <stdint.h>",
+        "#include <avr/pgmspace.h>",
+        '#include "clip_data.h"',
+    ]
+    for name, (bits, make) in CLIPS.items():
+        frames = make()
+        data, colors, keyframes = encode(frames, bits)
+        raw = len(frames) * NUM_STATIONS * 3
+        h.append("extern const uint8_t CLIP_%s[%d] PROGMEM;" % (name, len(data)))
+        cpp += [
+            "",
+            "// %d frames of %d ms, %d colours, %d keyframes: %d bytes (%d raw)"
+            % (len(frames), 1 << bits, colors, keyframes, len(data), raw),
+            "const uint8_t CLIP_%s[%d] PROGMEM = {" % (name, len(data)),
+        ]
+        for i in range(0, len(data), 16):
+            cpp.append("  " + ", ".join(str(v) for v in data[i:i + 16]) + ("," if i + 16 < len(data) else ""))
+        cpp.append("};")
+        print("CLIP_%s: %d bytes (%d raw)" % (name, len(data), raw))
+    h += ["", "#endif"]
+
+    with open(os.path.join(ROOT, "clip_data.h"), "w") as f:
+        f.write("\n".join(h) + "\n")
+    with open(os.path.join(ROOT, "clip_data.cpp"), "w") as f:
+        f.write("\n".join(cpp) + "\n")
+
+
+if __name__ == "__main__":
+    main()
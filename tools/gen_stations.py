@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+# Generates station_data.h and station_data.cpp from data/stations.csv and
+# data/lines.csv. Run from anywhere: python3 tools/gen_stations.py
+
+import csv
+import os
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+
+def read_csv(name):
+    with open(os.path.join(ROOT, "data", name), newline="") as f:
+        rows = [line for line in f if line.strip() and not line.startswith("#")]
+    return list(csv.DictReader(rows))
+
+
+def fail(message):
+    sys.exit("gen_stations: " + message)
+
+
+def main():
+    lines = read_csv("lines.csv")
+    stations = read_csv("stations.csv")
+    line_ids = [line["id"] for line in lines]
+    station_ids = [stn["id"] for stn in stations]
+
+    if len(lines) > 8:
+        fail("at most 8 lines fit in the line flags")
+    if len(stations) >= 0xFFFF:
+        fail("at most 65534 stations fit in station_t")
+    if len(set(station_ids)) != len(station_ids):
+        fail("duplicate station id")
+
+    x_order = [None] * len(stations)
+    links = []
+    for index, stn in enumerate(stations):
+        x = int(stn["x"])
+        if not 0 <= x < len(stations) or x_order[x] is not None:
+            fail("bad or duplicate x position for " + stn["id"])
+        x_order[x] = index
+        for line in stn["lines"].split():
+            if line not in line_ids:
+                fail("unknown line %s at %s" % (line, stn["id"]))
+        if not stn["lines"].split():
+            fail(stn["id"] + " is not on any line")
+        stn_links = stn["links"].split()
+        for link in stn_links:
+            if link not in station_ids:
+                fail("unknown link %s at %s" % (link, stn["id"]))
+            if stn["id"] not in stations[station_ids.index(link)]["links"].split():
+                fail("link %s - %s only goes one way" % (stn["id"], link))
+        links.append(stn_links)
+    max_links = max(len(stn_links) for stn_links in links)
+
+    header = [
+        "// Generated by tools/gen_stations.py from data/stations.csv and",
+        "// data/lines.csv. Do not edit by hand.",
+        "",
+    ]
+
+    h = header + [
+        "#ifndef _MKIII_STATION_DATA_H",
+        "#define _MKIII_STATION_DATA_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "#define NUM_STATIONS %d" % len(stations),
+        "#define MAX_STATION_LINKS %d" % max_links,
+        "#define NUM_LINES %d" % len(lines),
+        "",
+        "// Station IDs are one byte wide unless the network outgrows it.",
+        "#if NUM_STATIONS < 255",
+        "typedef uint8_t station_t;",
+        "#else",
+        "typedef uint16_t station_t;",
+        "#endif",
+        "",
+    ]
+    width = max(len(stn_id) for stn_id in station_ids) + 4
+    for index, stn_id in enumerate(station_ids):
+        h.append("#define %s %d" % (("STN_" + stn_id).ljust(width), index))
+    h += ["", "#define %s ((station_t) ~0)" % "NO_STATION".ljust(width), ""]
+    for index, line_id in enumerate(line_ids):
+        h.append("#define LINE_%s (1 << %d)" % (line_id, index))
+    h += [
+        "",
+        "extern const char* const STATION_NAMES[NUM_STATIONS];",
+        "extern const station_t STATION_X[NUM_STATIONS];",
+        "extern const station_t STATION_X_ORDER[NUM_STATIONS];",
+        "extern const uint8_t STATION_LINES[NUM_STATIONS];",
+        "extern const uint8_t STATION_COLOR_LINE[NUM_STATIONS];",
+        "extern const station_t STATION_LINKS[NUM_STATIONS][MAX_STATION_LINKS];",
+        "extern const uint8_t LINE_COLORS[NUM_LINES][3];",
+        "",
+        "#endif",
+    ]
+
+    def stn(index):
+        return "STN_" + station_ids[index]
+
+    cpp = header + [
+        "#include <avr/pgmspace.h>",
+        '#include "station_data.h"',
+        "",
+    ]
+    for index, row in enumerate(stations):
+        cpp.append('const char STATION_NAME_%d[] PROGMEM = "%s";' % (index, row["name"]))
+    cpp.append("const char* const STATION_NAMES[NUM_STATIONS] PROGMEM = {")
+    cpp += ["  STATION_NAME_%d," % index for index in range(len(stations))]
+    cpp += ["};", "", "const station_t STATION_X[NUM_STATIONS] PROGMEM = {"]
+    cpp += ["  %s, // %s" % (row["x"], stn(index)) for index, row in enumerate(stations)]
+    cpp += ["};", "", "const station_t STATION_X_ORDER[NUM_STATIONS] PROGMEM = {"]
+    cpp += ["  %s," % stn(index) for index in x_order]
+    cpp += ["};", "", "const uint8_t STATION_LINES[NUM_STATIONS] PROGMEM = {"]
+    for index, row in enumerate(stations):
+        flags = " | ".join("LINE_" + line for line in row["lines"].split())
+        cpp.append("  %s, // %s" % (flags, stn(index)))
+    cpp += ["};", "", "// Index of the line giving each station its colour",
+            "const uint8_t STATION_COLOR_LINE[NUM_STATIONS] PROGMEM = {"]
+    for index, row in enumerate(stations):
+        cpp.append("  %d, // %s" % (line_ids.index(row["lines"].split()[0]), stn(index)))
+    cpp += ["};", "", "const station_t STATION_LINKS[NUM_STATIONS][MAX_STATION_LINKS] PROGMEM = {"]
+    for index, stn_links in enumerate(links):
+        slots = ["STN_" + link for link in stn_links]
+        slots += ["NO_STATION"] * (max_links - len(slots))
+        cpp.append("  {%s}, // %s" % (", ".join(slots), stn(index)))
+    cpp += ["};", "", "const uint8_t LINE_COLORS[NUM_LINES][3] PROGMEM = {"]
+    for line in lines:
+        cpp.append("  {%s, %s, %s}, // LINE_%s" % (line["r"], line["g"], line["b"], line["id"]))
+    cpp += ["};"]
+
+    for name, text in (("station_data.h", h), ("station_data.cpp", cpp)):
+        with open(os.path.join(ROOT, name), "w") as f:
+            f.write("\n".join(text) + "\n")
+
+
+if __name__ == "__main__":
+    main()
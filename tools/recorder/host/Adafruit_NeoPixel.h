@@ -0,0 +1,43 @@
+// Stand-in for Adafruit_NeoPixel. The pixel data is kept in memory and
+// show() only counts the updates.
+
+#ifndef _MKIII_HOST_NEOPIXEL_H
+#define _MKIII_HOST_NEOPIXEL_H
+
+#include <Arduino.h>
+
+#define NEO_GRB     0
+#define NEO_KHZ800  0
+
+class Adafruit_NeoPixel {
+  public:
+    unsigned long shows = 0;
+
+    Adafruit_NeoPixel(uint16_t n, int16_t pin, uint16_t type) {
+      this->n = n;
+      pixels = (uint8_t *) calloc(n, 3);
+    }
+    ~Adafruit_NeoPixel() {
+      free(pixels);
+    }
+    void begin() {}
+    void show() {
+      shows++;
+    }
+    void clear() {
+      memset(pixels, 0, n * 3);
+    }
+    uint16_t numPixels() const {
+      return n;
+    }
+    uint8_t *getPixels() const {
+      return pixels;
+    }
+    static uint32_t gamma32(uint32_t x);
+
+  private:
+    uint16_t n;
+    uint8_t *pixels;
+};
+
+#endif
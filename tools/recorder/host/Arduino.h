@@ -0,0 +1,101 @@
+// Stand-in for the Arduino core, enough to run the renderers on a PC.
+// Time is a clock that each tool advances (the recorder frame by frame, a
+// virtual clock), and random() is seeded so every run picks the same
+// numbers.
+
+#ifndef _MKIII_HOST_ARDUINO_H
+#define _MKIII_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <string>
+#include <avr/pgmspace.h>
+
+class __FlashStringHelper;
+#define F(string) ((const __FlashStringHelper *) (string))
+
+extern unsigned long hostMillis;
+
+inline unsigned long millis() {
+  return hostMillis;
+}
+
+inline unsigned long micros() {
+  return hostMillis * 1000;
+}
+
+// Delays go by on the virtual clock
+inline void delay(unsigned long ms) {
+  hostMillis += ms;
+}
+
+#define LOW     0
+#define HIGH    1
+#define OUTPUT  1
+#define FALLING 2
+#define LED_BUILTIN 13
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalPinToInterrupt(uint8_t pin) {
+  return pin;
+}
+inline void attachInterrupt(int, void (*)(), int) {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+void randomSeed(unsigned long seed);
+long random(long howBig);
+long random(long howSmall, long howBig);
+
+// Serial reads from and writes to file descriptors that the tool sets (a
+// pty, for instance), or has nothing to read and drops what is written.
+// Numbers are printed in decimal, as Print does by default.
+class HostSerial {
+  public:
+    int input = -1;
+    int output = -1;
+
+    void begin(unsigned long) {}
+    int available() {
+      int count = 0;
+      if (input < 0 || ioctl(input, FIONREAD, &count) != 0) return 0;
+      return count;
+    }
+    int read() {
+      uint8_t value;
+      if (input < 0 || ::read(input, &value, 1) != 1) return -1;
+      return value;
+    }
+    size_t write(uint8_t value) {
+      if (output < 0) return 0;
+      return ::write(output, &value, 1) == 1 ? 1 : 0;
+    }
+    size_t print(const char *text) {
+      size_t count = 0;
+      while (text[count] != 0) write(text[count++]);
+      return count;
+    }
+    size_t print(const __FlashStringHelper *text) {
+      return print((const char *) text);
+    }
+    size_t print(char value) {
+      return write(value);
+    }
+    template <typename T> size_t print(T value) {
+      return print(std::to_string(value).c_str());
+    }
+    size_t println() {
+      return print("\r\n");
+    }
+    template <typename T> size_t println(T value) {
+      size_t count = print(value);
+      return count + println();
+    }
+};
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,32 @@
+// Stand-in for the EEPROM library: 1 KB (as on the Uno) in memory, erased
+// (all 0xFF) at the start.
+
+#ifndef _MKIII_HOST_EEPROM_H
+#define _MKIII_HOST_EEPROM_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define HOST_EEPROM_SIZE 1024
+
+class EEPROMClass {
+  public:
+    EEPROMClass() {
+      memset(data, 0xFF, sizeof(data));
+    }
+    uint8_t read(int address) {
+      return data[address % HOST_EEPROM_SIZE];
+    }
+    void write(int address, uint8_t value) {
+      data[address % HOST_EEPROM_SIZE] = value;
+    }
+    void update(int address, uint8_t value) {
+      write(address, value);
+    }
+
+  private:
+    uint8_t data[HOST_EEPROM_SIZE];
+};
+static EEPROMClass EEPROM;
+
+#endif
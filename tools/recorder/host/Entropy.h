@@ -0,0 +1,19 @@
+// Stand-in for the Entropy library. The sketch only uses it to seed
+// random(), which the recorder seeds itself.
+
+#ifndef _MKIII_HOST_ENTROPY_H
+#define _MKIII_HOST_ENTROPY_H
+
+#include <stdint.h>
+
+class EntropyClass {
+  public:
+    EntropyClass() {}
+    void initialize() {}
+    uint32_t random() {
+      return 0;
+    }
+};
+static EntropyClass Entropy;
+
+#endif
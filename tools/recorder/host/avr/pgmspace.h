@@ -0,0 +1,13 @@
+// Stand-in for avr/pgmspace.h: flash is ordinary memory on a PC.
+
+#ifndef _MKIII_HOST_PGMSPACE_H
+#define _MKIII_HOST_PGMSPACE_H
+
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *) (address))
+#define pgm_read_word(address) (*(const uint16_t *) (address))
+#define pgm_read_ptr(address) (*(void * const *) (address))
+
+#endif
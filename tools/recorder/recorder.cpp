@@ -0,0 +1,409 @@
+// Records every mode's output off-device, to check that a change to the
+// renderers still draws the same frames, and benchmarks them.
+// The sketch itself is built in, against stand-ins for the Arduino core and
+// libraries (tools/recorder/host), and its setup() runs first. Each
+// sequence (a mode and submode, a static preview, an editor screen, an
+// animation or a crossfade between modes) then runs for a fixed number of
+// frames through the sketch's own functions (renderWithMode(),
+// renderStaticWithMode(), renderEditor(), ...), on a virtual clock, with
+// random() seeded the same way every time. The frames sent to the strip are
+// written as deltas (only the pixels that changed), and can be compared
+// against an earlier recording.
+//
+// For every sequence it reports:
+// - strip updates (show()), in total and per virtual second
+// - the pixel writes made by the renderer, per frame and against the pixels
+//   that actually changed (which shows renderers that repaint far more than
+//   they need to)
+// - the time each frame takes to render and show, on this machine (only
+//   useful to compare changes against each other)
+// - how many frames the sketch would idle through
+//
+// Built with -DMKIII_PROFILE (and profile.cpp), it also prints the sketch's
+// profile probes after each sequence, as the 'p' command does. Only their
+// counts mean anything here: micros() is on the virtual clock, which stands
+// still during a frame.
+//
+// The sketch idles after a frame until the display next changes (see
+// scheduler.h), for as long as its idleTime() says. The recorder still
+// renders every frame, but fails if any frame that would have been idled
+// through changed the display (the mode woke up too late).
+//
+// Build from the repository root:
+//   g++ -O2 -DMKIII_RENDER_STATS -Itools/recorder/host -I. -o recorder
+//     tools/recorder/recorder.cpp modes.cpp diagram.cpp stations.cpp
+//     station_data.cpp colors.cpp curves.cpp animations.cpp clip.cpp
+//     clip_data.cpp trains.cpp scheduler.cpp input.cpp stream.cpp
+// Then:
+//   ./recorder --check tools/recorder/golden.rec
+//       Compare against the checked-in recording (exit code 1 if any
+//       sequence differs)
+//   ./recorder --record tools/recorder/golden.rec
+//       Write a new one, after a change that is meant to change the frames
+//       (commit it with the change)
+// The exit code is also 1 if a mode woke up too late.
+//
+// Recording format: "MKR1", the pixel count, then for each sequence its name
+// length and name, its frame count (16 bit, little endian), and each frame as
+// the number of changed pixels followed by (pixel, 3 pixel data bytes) for
+// each. Frames start from all pixels off.
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <Arduino.h>
+#include "MKIII_Line_Diagram.ino"
+
+#define SEED 1
+
+unsigned long hostMillis = 0;
+HostSerial Serial;
+static uint32_t randomState;
+
+// The recorder never waits for a frame, but the scheduler is built in
+void idleCpu() {
+  hostMillis++;
+}
+
+void randomSeed(unsigned long seed) {
+  randomState = seed;
+}
+
+long random(long howBig) {
+  if (howBig == 0) return 0;
+  randomState = randomState * 1103515245 + 12345;
+  return (randomState >> 8) % howBig;
+}
+
+long random(long howSmall, long howBig) {
+  if (howSmall >= howBig) return howSmall;
+  return howSmall + random(howBig - howSmall);
+}
+
+#define KIND_RENDER    0
+#define KIND_STATIC    1
+#define KIND_EDIT      2 // Mode 4/5 editor screens
+#define KIND_ANIMATION 3
+#define KIND_FADE      4 // Mode 1 crossfading into the mode
+
+typedef struct Sequence {
+  const char *name;
+  uint8_t kind;
+  uint8_t id; // Mode or animation
+  uint8_t submode;
+  uint16_t frames; // Animations stop early when they finish
+} Sequence;
+
+const Sequence SEQUENCES[] = {
+  {"mode0", KIND_RENDER, 0, 0, 500},
+  {"mode0-static", KIND_STATIC, 0, 0, 1},
+  {"mode1-0", KIND_RENDER, 1, 0, 5},
+  {"mode1-1", KIND_RENDER, 1, 1, 5},
+  {"mode1-static", KIND_STATIC, 1, 0, 1},
+  {"mode2-0", KIND_RENDER, 2, 0, 300},
+  {"mode2-1", KIND_RENDER, 2, 1, 300},
+  {"mode2-2", KIND_RENDER, 2, 2, 300},
+  {"mode2-3", KIND_RENDER, 2, 3, 300},
+  {"mode2-static", KIND_STATIC, 2, 0, 1},
+  {"mode3-0", KIND_RENDER, 3, 0, 1000},
+  {"mode3-1", KIND_RENDER, 3, 1, 3000},
+  {"mode3-static", KIND_STATIC, 3, 0, 1},
+  {"fade-mode3", KIND_FADE, 3, 0, 50},
+  {"mode4", KIND_RENDER, 4, 0, 5},
+  {"mode4-edit", KIND_EDIT, 4, 0, 1},
+  {"mode4-static", KIND_STATIC, 4, 0, 1},
+  {"mode5", KIND_RENDER, 5, 0, 5},
+  {"mode5-edit", KIND_EDIT, 5, 0, 1},
+  {"mode5-static", KIND_STATIC, 5, 0, 1},
+  {"mode6-static", KIND_STATIC, 6, 0, 1},
+  {"animation-off", KIND_ANIMATION, ANIMATION_OFF, 0, 1000},
+  {"animation-wipe", KIND_ANIMATION, ANIMATION_WIPE, 0, 1000},
+  {"animation-unwipe", KIND_ANIMATION, ANIMATION_UNWIPE, 0, 1000},
+  {"animation-flash", KIND_ANIMATION, ANIMATION_FLASH, 0, 1000},
+};
+#define NUM_SEQUENCES (sizeof(SEQUENCES) / sizeof(SEQUENCES[0]))
+
+// A changed pixel: its index and its 3 bytes of pixel data
+typedef struct Change {
+  uint8_t pixel;
+  uint8_t data[3];
+} Change;
+
+typedef std::vector<Change> Frame;
+
+typedef struct Recording {
+  std::string name;
+  std::vector<Frame> frames;
+} Recording;
+
+// Renders and shows one frame of the sequence, as the sketch's loop() does.
+// Returns false once an animation has drawn its last step.
+static bool renderFrame(const Sequence *sequence) {
+  switch (sequence->kind) {
+    case KIND_RENDER:
+    case KIND_FADE:
+      renderWithMode();
+      return true;
+    case KIND_STATIC:
+      renderStaticWithMode();
+      return true;
+    case KIND_EDIT:
+      renderEditor();
+      return true;
+    default: {
+      bool playing = animation_render(&diagram);
+      scheduler.show();
+      return playing;
+    }
+  }
+}
+
+typedef std::chrono::steady_clock Clock;
+
+// Returns false if the mode changed the display while it would have been
+// idle.
+static bool record(const Sequence *sequence, Recording *recording) {
+  // Start every sequence from the same state
+  hostMillis = 0;
+  randomSeed(SEED);
+  strip.clear();
+  // Including the dithering, which steps with every send
+  diagram = LineDiagram(&strip);
+  diagram.setBrightness(70);
+  diagram.clear();
+  diagram.commit();
+  modeSettings = ModeSettings();
+  modeSettings.mode1Submode = sequence->submode;
+  modeSettings.mode2Submode = sequence->submode;
+  modeSettings.mode3Submode = sequence->submode;
+  IRMode.enabled = false;
+  Sleep.asleep = false;
+  Editor.mode = EDITOR_NONE;
+  Editor.changed = false;
+  animation = Animation();
+  // Starting the sequence counts (editors draw straight away)
+  diagram.stats = RenderStats();
+  unsigned long shows = strip.shows;
+  if (sequence->kind == KIND_ANIMATION) {
+    animate(sequence->id);
+  } else if (sequence->kind == KIND_FADE) {
+    modeSettings.mode1Submode = 1;
+    Rendering.currentMode = 1;
+    mode_enter(1);
+    renderWithMode();
+    setMode(sequence->id);
+    showModeChange();
+    // Not the frame it fades from
+    diagram.stats = RenderStats();
+    shows = strip.shows;
+  } else {
+    Rendering.currentMode = sequence->id;
+    mode_enter(sequence->id);
+    if (sequence->kind == KIND_EDIT) {
+      if (sequence->id == 4) mode4_startEdit();
+      else mode5_startEdit();
+    }
+  }
+
+  uint8_t previous[NUM_STATIONS * 3];
+  memset(previous, 0, sizeof(previous));
+  unsigned long changes = 0;
+  unsigned long maxChanges = 0;
+  // Frames before this time would not be rendered by the sketch
+  unsigned long wakeTime = 0;
+  unsigned long idleFrames = 0;
+  unsigned long lateFrames = 0;
+  double renderTotal = 0, renderMax = 0;
+
+  recording->name = sequence->name;
+  recording->frames.clear();
+  for (uint16_t i = 0; i < sequence->frames; i++) {
+    hostMillis += FRAME_DELAY;
+    Clock::time_point start = Clock::now();
+    bool playing = renderFrame(sequence);
+    double renderTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    renderTotal += renderTime;
+    if (renderTime > renderMax) renderMax = renderTime;
+    Frame frame;
+    const uint8_t *pixels = strip.getPixels();
+    for (uint8_t pixel = 0; pixel < NUM_STATIONS; pixel++) {
+      if (memcmp(&pixels[pixel * 3], &previous[pixel * 3], 3) == 0) continue;
+      Change change;
+      change.pixel = pixel;
+      memcpy(change.data, &pixels[pixel * 3], 3);
+      frame.push_back(change);
+    }
+    memcpy(previous, pixels, sizeof(previous));
+    if ((long) (hostMillis - wakeTime) < 0) {
+      idleFrames++;
+      if (!frame.empty()) lateFrames++;
+    } else {
+      // scheduler.idle() doesn't idle for a frame or less
+      unsigned long idle = idleTime();
+      if (idle > SCHEDULER_IDLE_MAX) idle = SCHEDULER_IDLE_MAX;
+      if (idle > FRAME_DELAY) wakeTime = hostMillis + idle;
+    }
+    changes += frame.size();
+    if (frame.size() > maxChanges) maxChanges = frame.size();
+    recording->frames.push_back(frame);
+    if (!playing) break;
+  }
+
+  unsigned long frames = recording->frames.size();
+  unsigned long writes = diagram.stats.pixelWrites;
+  unsigned long sent = strip.shows - shows;
+  printf("%-18s %5lu frames %5lu shows (%4.1f/s) %7lu writes (%4.1f/frame) %6lu changed (max %2lu/frame)",
+         sequence->name, frames, sent, sent * 1000.0 / (frames * FRAME_DELAY),
+         writes, (double) writes / frames, changes, maxChanges);
+  if (changes > 0) printf(" %5.1f writes/change", (double) writes / changes);
+  printf(" %6.1f/%6.1f us avg/max %3lu%% idle\n", renderTotal / frames, renderMax, idleFrames * 100 / frames);
+  if (lateFrames > 0) {
+    printf("%s: %lu frames changed while idle\n", sequence->name, lateFrames);
+    return false;
+  }
+  return true;
+}
+
+static void writeU16(FILE *file, uint16_t value) {
+  fputc(value & 0xFF, file);
+  fputc(value >> 8, file);
+}
+
+static bool save(const char *path, const std::vector<Recording> &recordings) {
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) return false;
+  fputs("MKR1", file);
+  fputc(NUM_STATIONS, file);
+  for (size_t i = 0; i < recordings.size(); i++) {
+    const Recording *recording = &recordings[i];
+    fputc(recording->name.size(), file);
+    fputs(recording->name.c_str(), file);
+    writeU16(file, recording->frames.size());
+    for (size_t j = 0; j < recording->frames.size(); j++) {
+      const Frame *frame = &recording->frames[j];
+      fputc(frame->size(), file);
+      for (size_t k = 0; k < frame->size(); k++) {
+        fputc((*frame)[k].pixel, file);
+        fwrite((*frame)[k].data, 1, 3, file);
+      }
+    }
+  }
+  return fclose(file) == 0;
+}
+
+static bool load(const char *path, std::vector<Recording> *recordings) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) return false;
+  char magic[4];
+  bool ok = fread(magic, 1, 4, file) == 4 && memcmp(magic, "MKR1", 4) == 0 && fgetc(file) == NUM_STATIONS;
+  int length;
+  while (ok && (length = fgetc(file)) != EOF) {
+    Recording recording;
+    recording.name.resize(length);
+    int low = 0, high = 0;
+    ok = fread(&recording.name[0], 1, length, file) == (size_t) length
+      && (low = fgetc(file)) != EOF && (high = fgetc(file)) != EOF;
+    for (int i = 0; ok && i < (low | (high << 8)); i++) {
+      int count = fgetc(file);
+      Frame frame(count == EOF ? 0 : count);
+      ok = count != EOF;
+      for (int j = 0; ok && j < count; j++) {
+        int pixel = fgetc(file);
+        frame[j].pixel = pixel;
+        ok = pixel != EOF && pixel < NUM_STATIONS && fread(frame[j].data, 1, 3, file) == 3;
+      }
+      recording.frames.push_back(frame);
+    }
+    recordings->push_back(recording);
+  }
+  fclose(file);
+  return ok;
+}
+
+// Compares two recordings by replaying their deltas. Prints the first frame
+// that differs.
+static bool compare(const Recording *expected, const Recording *actual) {
+  uint8_t a[NUM_STATIONS * 3], b[NUM_STATIONS * 3];
+  memset(a, 0, sizeof(a));
+  memset(b, 0, sizeof(b));
+  size_t frames = expected->frames.size();
+  if (actual->frames.size() > frames) frames = actual->frames.size();
+  for (size_t i = 0; i < frames; i++) {
+    if (i < expected->frames.size()) {
+      const Frame *frame = &expected->frames[i];
+      for (size_t j = 0; j < frame->size(); j++) memcpy(&a[(*frame)[j].pixel * 3], (*frame)[j].data, 3);
+    }
+    if (i < actual->frames.size()) {
+      const Frame *frame = &actual->frames[i];
+      for (size_t j = 0; j < frame->size(); j++) memcpy(&b[(*frame)[j].pixel * 3], (*frame)[j].data, 3);
+    }
+    if (i >= expected->frames.size() || i >= actual->frames.size()) {
+      printf("%s: %lu frames, expected %lu\n", actual->name.c_str(),
+             (unsigned long) actual->frames.size(), (unsigned long) expected->frames.size());
+      return false;
+    }
+    if (memcmp(a, b, sizeof(a)) == 0) continue;
+    printf("%s: frame %lu differs at stations", actual->name.c_str(), (unsigned long) i);
+    for (uint8_t stn = 0; stn < NUM_STATIONS; stn++) {
+      if (memcmp(&a[stn * 3], &b[stn * 3], 3) != 0) printf(" %u", stn);
+    }
+    printf("\n");
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  const char *recordPath = NULL;
+  const char *checkPath = NULL;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--record") == 0) recordPath = argv[i + 1];
+    else if (strcmp(argv[i], "--check") == 0) checkPath = argv[i + 1];
+  }
+  if (argc % 2 == 0 || (recordPath == NULL && checkPath == NULL && argc > 1)) {
+    fprintf(stderr, "Usage: %s [--record FILE] [--check FILE]\n", argv[0]);
+    return 2;
+  }
+
+  setup();
+#ifdef MKIII_PROFILE
+  Serial.output = STDOUT_FILENO;
+#endif
+  std::vector<Recording> recordings(NUM_SEQUENCES);
+  bool woke = true;
+  for (size_t i = 0; i < NUM_SEQUENCES; i++) {
+    if (!record(&SEQUENCES[i], &recordings[i])) woke = false;
+#ifdef MKIII_PROFILE
+    fflush(stdout);
+    profilePrint();
+#endif
+  }
+
+  if (recordPath != NULL && !save(recordPath, recordings)) {
+    fprintf(stderr, "Could not write %s\n", recordPath);
+    return 2;
+  }
+  if (checkPath == NULL) return woke ? 0 : 1;
+
+  std::vector<Recording> expected;
+  if (!load(checkPath, &expected)) {
+    fprintf(stderr, "Could not read %s\n", checkPath);
+    return 2;
+  }
+  bool same = true;
+  for (size_t i = 0; i < recordings.size(); i++) {
+    const Recording *match = NULL;
+    for (size_t j = 0; j < expected.size(); j++) {
+      if (expected[j].name == recordings[i].name) match = &expected[j];
+    }
+    if (match == NULL) {
+      printf("%s: not in %s\n", recordings[i].name.c_str(), checkPath);
+      same = false;
+    } else if (!compare(match, &recordings[i])) {
+      same = false;
+    }
+  }
+  printf(same ? "All sequences match %s\n" : "Sequences differ from %s\n", checkPath);
+  return same && woke ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+// The original pathfind(), for comparing routes against (see legacy.cpp).
+
+#ifndef _MKIII_LEGACY_H
+#define _MKIII_LEGACY_H
+
+#include <stdint.h>
+#include "station_data.h"
+
+// Long enough for the routes that turned back at Lougheed and so went
+// through some stations twice.
+#define LEGACY_PATH_MAX (NUM_STATIONS * 2)
+
+typedef struct LegacyPath {
+  uint8_t size = 0;
+  uint8_t path[LEGACY_PATH_MAX];
+} LegacyPath;
+
+LegacyPath* legacyPathfind(LegacyPath *path, uint8_t from, uint8_t to);
+
+#endif
@@ -0,0 +1,313 @@
+// Checks the route engine off-device, and times it.
+// Every pair of stations is routed with routeFind() and routeDecode(), and
+// each result is checked against a reference search that shares no code
+// with stations.cpp: it reads the network from data/stations.csv, and
+// searches over (station, direction) states, so that the turns that need a
+// reversal (the wyes at Columbia and Lougheed) are handled exactly. Each
+// route must:
+// - be empty exactly when the reference finds no route
+// - start and end at the right stations
+// - only step between linked stations, never through a wye
+// - not visit a station twice
+// - be as short as the reference route
+// - contain exactly its stations (routeContains()), and shrink by one
+//   station at a time from the tail with routeDropTail()
+// Each route is also compared with the original recursive pathfind()
+// (legacy.cpp), which the route engine replaced: it must be the same route,
+// except where the original turned back at Lougheed to the station it came
+// from (Burquitlam to Lafarge went Burquitlam, Lougheed, Burquitlam, ...),
+// where it must be the original route with that loop cut out.
+// Then every pair is timed (host time, so only useful to compare changes to
+// the engine against each other).
+//
+// Build from the repository root:
+//   g++ -O2 -Itools/recorder/host -I. -o routecheck
+//     tools/routecheck/routecheck.cpp tools/routecheck/legacy.cpp
+//     stations.cpp station_data.cpp
+// Then:
+//   ./routecheck [--reps N] [--data data/stations.csv]
+// The exit code is 1 if any route is wrong.
+//
+// routeFind() is not recursive: the search goes one level per hop, so its
+// depth is the longest route, and its stack use is its fixed working
+// arrays, printed at the end. Build stations.cpp with -fstack-usage for the
+// whole frame.
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "stations.h"
+#include "legacy.h"
+
+// The host Arduino.h declares these for the recorder; nothing here uses them.
+unsigned long hostMillis = 0;
+
+typedef std::vector<std::vector<int> > Network;
+
+// Turns that need a reversal, as in the real network: a route may not go
+// between the outer two through the middle one.
+static const char *WYES[][3] = {
+  {"SCOTT_ROAD", "COLUMBIA", "SAPPERTON"},
+  {"BURQUITLAM", "LOUGHEED", "BRAID"}
+};
+#define NUM_WYES (sizeof(WYES) / sizeof(WYES[0]))
+
+static std::map<std::string, int> ids;
+static int wyes[NUM_WYES][3];
+
+static std::vector<std::string> split(const std::string &text, char separator) {
+  std::vector<std::string> fields;
+  size_t start = 0;
+  while (true) {
+    size_t end = text.find(separator, start);
+    fields.push_back(text.substr(start, end == std::string::npos ? std::string::npos : end - start));
+    if (end == std::string::npos) return fields;
+    start = end + 1;
+  }
+}
+
+// Reads the links from the station table. Returns false if it doesn't match
+// the generated data.
+static bool loadNetwork(const char *path, Network *network) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) return false;
+  std::vector<std::vector<std::string> > rows;
+  char line[512];
+  bool header = true;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    std::string text(line);
+    while (!text.empty() && (text[text.size() - 1] == '\n' || text[text.size() - 1] == '\r')) text.erase(text.size() - 1);
+    if (text.empty() || text[0] == '#') continue;
+    if (header) {
+      header = false;
+      continue;
+    }
+    std::vector<std::string> fields = split(text, ',');
+    if (fields.size() != 5) return false;
+    ids[fields[0]] = rows.size();
+    rows.push_back(fields);
+  }
+  fclose(file);
+  if (rows.size() != NUM_STATIONS) return false;
+  network->assign(rows.size(), std::vector<int>());
+  for (size_t i = 0; i < rows.size(); i++) {
+    std::vector<std::string> links = split(rows[i][4], ' ');
+    for (size_t j = 0; j < links.size(); j++) {
+      if (ids.count(links[j]) == 0) return false;
+      (*network)[i].push_back(ids[links[j]]);
+    }
+  }
+  for (size_t i = 0; i < NUM_WYES; i++) {
+    for (int j = 0; j < 3; j++) {
+      if (ids.count(WYES[i][j]) == 0) return false;
+      wyes[i][j] = ids[WYES[i][j]];
+    }
+  }
+  return true;
+}
+
+static bool linked(const Network &network, int a, int b) {
+  for (size_t i = 0; i < network[a].size(); i++) {
+    if (network[a][i] == b) return true;
+  }
+  return false;
+}
+
+static bool throughWye(int a, int via, int b) {
+  for (size_t i = 0; i < NUM_WYES; i++) {
+    if (wyes[i][1] != via) continue;
+    if ((a == wyes[i][0] && b == wyes[i][2]) || (a == wyes[i][2] && b == wyes[i][0])) return true;
+  }
+  return false;
+}
+
+// Breadth-first search over (previous station, station) states, so a
+// station can be reached again from another direction. Returns the shortest
+// route from start to end, or an empty one.
+static std::vector<int> referenceRoute(const Network &network, int from, int to) {
+  int count = network.size();
+  // States are previous * (count + 1) + station, previous == count at the start
+  std::vector<int> parent((count + 1) * count, -2);
+  std::vector<int> queue;
+  int start = count * count + from;
+  parent[start] = -1;
+  queue.push_back(start);
+  for (size_t head = 0; head < queue.size(); head++) {
+    int state = queue[head];
+    int previous = state / count;
+    int station = state % count;
+    if (station == to) {
+      std::vector<int> route;
+      for (int s = state; s != -1; s = parent[s]) route.insert(route.begin(), s % count);
+      return route;
+    }
+    for (size_t i = 0; i < network[station].size(); i++) {
+      int next = network[station][i];
+      if (next == previous || (previous != count && throughWye(previous, station, next))) continue;
+      int nextState = station * count + next;
+      if (parent[nextState] != -2) continue;
+      parent[nextState] = state;
+      queue.push_back(nextState);
+    }
+  }
+  return std::vector<int>();
+}
+
+static int failures = 0;
+static int turnBacks = 0;
+
+static void fail(station_t from, station_t to, const char *problem) {
+  if (failures++ < 20) {
+    printf("%s to %s: %s\n", (const char *) stationName(from), (const char *) stationName(to), problem);
+  }
+}
+
+// Compares a route with the original pathfind()'s. A station the original
+// went through twice is where it turned back: the stations after the first
+// visit, up to the second, are cut out before comparing.
+static void checkLegacy(station_t from, station_t to, const StationPath *path) {
+  LegacyPath legacy;
+  legacyPathfind(&legacy, from, to);
+  std::vector<int> original(legacy.path, legacy.path + legacy.size);
+  bool turnedBack = false;
+  for (size_t i = 0; i < original.size(); i++) {
+    for (size_t j = original.size() - 1; j > i; j--) {
+      if (original[j] == original[i]) {
+        original.erase(original.begin() + i + 1, original.begin() + j + 1);
+        turnedBack = true;
+        break;
+      }
+    }
+  }
+  std::vector<int> route(path->path, path->path + path->size);
+  if (route != original) fail(from, to, "differs from the original pathfind()");
+  else if (turnedBack) turnBacks++;
+}
+
+static void check(const Network &network, station_t from, station_t to) {
+  Route route;
+  StationPath path;
+  routeDecode(routeFind(&route, from, to), &path);
+  checkLegacy(from, to, &path);
+  std::vector<int> reference = referenceRoute(network, from, to);
+
+  if (path.size == 0 || reference.empty()) {
+    if (path.size != 0) fail(from, to, "found a route where there is none");
+    else if (!reference.empty()) fail(from, to, "found no route");
+    return;
+  }
+  if (path.path[0] != from || path.path[path.size - 1] != to) fail(from, to, "wrong termini");
+  std::vector<bool> seen(NUM_STATIONS, false);
+  for (station_t i = 0; i < path.size; i++) {
+    station_t stn = path.path[i];
+    if (stn >= NUM_STATIONS) {
+      fail(from, to, "station out of range");
+      return;
+    }
+    if (seen[stn]) fail(from, to, "visits a station twice");
+    seen[stn] = true;
+    if (i > 0 && !linked(network, path.path[i - 1], stn)) fail(from, to, "steps between stations that aren't linked");
+    if (i > 1 && throughWye(path.path[i - 2], path.path[i - 1], stn)) fail(from, to, "goes through a wye");
+  }
+  if (path.size != reference.size()) fail(from, to, "longer than the reference route");
+  for (station_t stn = 0; stn < NUM_STATIONS; stn++) {
+    if (routeContains(&route, stn) != seen[stn]) {
+      fail(from, to, "routeContains() doesn't match the route");
+      break;
+    }
+  }
+  // The tail shrinks back along the route
+  for (station_t size = path.size - 1; size > 0; size--) {
+    routeDropTail(&route);
+    if (route.size != size || route.tail != path.path[size - 1] || routeContains(&route, path.path[size])) {
+      fail(from, to, "routeDropTail() leaves the route");
+      break;
+    }
+  }
+}
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char **argv) {
+  const char *dataPath = "data/stations.csv";
+  long reps = 2000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--data") == 0) dataPath = argv[i + 1];
+    else if (strcmp(argv[i], "--reps") == 0) reps = atol(argv[i + 1]);
+  }
+  if (argc % 2 == 0 || reps <= 0) {
+    fprintf(stderr, "Usage: %s [--reps N] [--data FILE]\n", argv[0]);
+    return 2;
+  }
+  Network network;
+  if (!loadNetwork(dataPath, &network)) {
+    fprintf(stderr, "Could not read %s, or it doesn't match station_data.h\n", dataPath);
+    return 2;
+  }
+  // The generated links must be the ones in the table
+  for (station_t stn = 0; stn < NUM_STATIONS; stn++) {
+    for (uint8_t slot = 0; slot < MAX_STATION_LINKS; slot++) {
+      station_t link = stationLink(stn, slot);
+      if (link != NO_STATION && !linked(network, stn, link)) {
+        fprintf(stderr, "station_data.cpp is out of date with %s\n", dataPath);
+        return 2;
+      }
+    }
+  }
+
+  unsigned long routes = 0;
+  station_t longest = 0;
+  for (station_t from = 0; from < NUM_STATIONS; from++) {
+    for (station_t to = 0; to < NUM_STATIONS; to++) {
+      check(network, from, to);
+      std::vector<int> reference = referenceRoute(network, from, to);
+      if (!reference.empty()) routes++;
+      if (reference.size() > longest) longest = reference.size();
+    }
+  }
+  printf("%d pairs, %lu with a route, longest %u stations: %d failures\n",
+         NUM_STATIONS * NUM_STATIONS, routes, longest, failures);
+  printf("Same routes as the original pathfind(), except %d that no longer turn back\n", turnBacks);
+
+  // Time each pair, then report the spread over all pairs
+  double findTotal = 0, findMax = 0, findMin = 1e30, decodeTotal = 0;
+  station_t slowFrom = 0, slowTo = 0;
+  for (station_t from = 0; from < NUM_STATIONS; from++) {
+    for (station_t to = 0; to < NUM_STATIONS; to++) {
+      Route route;
+      StationPath path;
+      Clock::time_point start = Clock::now();
+      for (long i = 0; i < reps; i++) {
+        routeFind(&route, from, to);
+        __asm__ __volatile__("" : : "r"(&route) : "memory");
+      }
+      Clock::time_point found = Clock::now();
+      for (long i = 0; i < reps; i++) {
+        routeDecode(&route, &path);
+        __asm__ __volatile__("" : : "r"(&path) : "memory");
+      }
+      Clock::time_point decoded = Clock::now();
+      double find = std::chrono::duration<double, std::nano>(found - start).count() / reps;
+      double decode = std::chrono::duration<double, std::nano>(decoded - found).count() / reps;
+      findTotal += find;
+      decodeTotal += decode;
+      if (find < findMin) findMin = find;
+      if (find > findMax) {
+        findMax = find;
+        slowFrom = from;
+        slowTo = to;
+      }
+    }
+  }
+  int pairs = NUM_STATIONS * NUM_STATIONS;
+  printf("routeFind    min/avg/max %.0f/%.0f/%.0f ns (slowest %s to %s)\n", findMin, findTotal / pairs, findMax,
+         (const char *) stationName(slowFrom), (const char *) stationName(slowTo));
+  printf("routeDecode  avg %.0f ns\n", decodeTotal / pairs);
+  printf("routeFind working arrays: %u bytes of stack, %u levels deep at most\n",
+         (unsigned) (NUM_STATIONS * sizeof(station_t) + 3 * BITSET_BYTES(NUM_STATIONS)), longest - 1);
+  return failures == 0 ? 0 : 1;
+}
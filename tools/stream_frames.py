@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+# Streams recorded frames to the line diagram in Mode 6 (see stream.h).
+#
+#   python3 tools/stream_frames.py play /dev/ttyACM0 frames.bin
+#   python3 tools/stream_frames.py generate frames.bin
+#
+# A recording is raw frames back to back, 3 bytes (red, green, blue) per
+# station in data order. "generate" writes a test recording. To try it on
+# Linux without a board, play to the pty of tools/streamdevice, which runs
+# the sketch's own decoder (see the top of
+# tools/streamdevice/streamdevice.cpp).
+
+import argparse
+import os
+import select
+import sys
+import termios
+import time
+import tty
+
+NUM_STATIONS = 39
+BAUD = termios.B500000 if hasattr(termios, "B500000") else termios.B230400
+
+SYNC = 0xA5
+REPLY_SHOWN = ord("K")
+REPLY_BAD = ord("E")
+REPLY_BUSY = ord("B")
+
+
+def open_port(path):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    attrs[4] = attrs[5] = BAUD
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def fletcher16(data):
+    a = b = 0
+    for value in data:
+        a = (a + value) % 255
+        b = (b + a) % 255
+    return a, b
+
+
+def packet(frame):
+    body = len(frame).to_bytes(2, "little") + frame
+    return bytes([SYNC]) + body + bytes(fletcher16(body))
+
+
+def read_reply(fd, timeout):
+    # Skips any text the board prints, replies are single bytes.
+    deadline = time.monotonic() + timeout
+    while True:
+        left = deadline - time.monotonic()
+        if left <= 0 or not select.select([fd], [], [], left)[0]:
+            return None
+        value = os.read(fd, 1)[0]
+        if value in (REPLY_SHOWN, REPLY_BAD, REPLY_BUSY):
+            return value
+
+
+def play(args):
+    with open(args.frames, "rb") as f:
+        data = f.read()
+    size = args.stations * 3
+    frames = [data[i:i + size] for i in range(0, len(data) - size + 1, size)]
+    if not frames:
+        sys.exit("stream_frames: no whole frames in " + args.frames)
+    fd = open_port(args.port)
+    counts = {REPLY_SHOWN: 0, REPLY_BAD: 0, REPLY_BUSY: 0, None: 0}
+    period = 1.0 / args.fps
+    late = 0
+    start = next_frame = time.monotonic()
+    for loop in range(args.loops):
+        for frame in frames:
+            now = time.monotonic()
+            if now < next_frame:
+                time.sleep(next_frame - now)
+            elif now - next_frame > period:
+                late += 1
+            next_frame += period
+            os.write(fd, packet(frame))
+            counts[read_reply(fd, args.timeout)] += 1
+    elapsed = time.monotonic() - start
+    sent = len(frames) * args.loops
+    print("Sent %d frames in %.2f s (%.1f fps)" % (sent, elapsed, sent / elapsed))
+    print("Shown %d, bad %d, busy %d, no reply %d, late %d" % (
+        counts[REPLY_SHOWN], counts[REPLY_BAD], counts[REPLY_BUSY], counts[None], late))
+    os.close(fd)
+    return 0 if counts[REPLY_SHOWN] == sent else 1
+
+
+def generate(args):
+    # A dot of each colour in turn running along the stations
+    colors = [(255, 0, 0), (0, 255, 0), (0, 0, 255)]
+    with open(args.frames, "wb") as f:
+        for i in range(args.count):
+            frame = bytearray(args.stations * 3)
+            stn = i % args.stations
+            frame[stn * 3:stn * 3 + 3] = colors[(i // args.stations) % len(colors)]
+            f.write(frame)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Stream frames to the line diagram (Mode 6).")
+    parser.add_argument("--stations", type=int, default=NUM_STATIONS)
+    commands = parser.add_subparsers(dest="command", required=True)
+    p = commands.add_parser("play", help="stream a recording to the board")
+    p.add_argument("port")
+    p.add_argument("frames")
+    p.add_argument("--fps", type=float, default=50)
+    p.add_argument("--loops", type=int, default=1)
+    p.add_argument("--timeout", type=float, default=0.1, help="seconds to wait for each reply")
+    p.set_defaults(run=play)
+    p = commands.add_parser("generate", help="write a test recording")
+    p.add_argument("frames")
+    p.add_argument("--count", type=int, default=NUM_STATIONS * 3)
+    p.set_defaults(run=generate)
+    args = parser.parse_args()
+    return args.run(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,114 @@
+// Runs the sketch's stream decoder (stream.cpp) on Linux, behind a pty, so
+// that the host side of Mode 6 can be tested without a board. It opens a
+// pty and prints its path. tools/stream_frames.py then plays frames to that
+// path. Each byte goes through stream_read() as on the board, and the
+// replies go back through the pty. Shown frames are counted. With --save,
+// the pixel data of each one is written out, which should match the
+// recording that was played.
+//
+// Build from the repository root:
+//   g++ -O2 -Itools/recorder/host -I. -o streamdevice
+//     tools/streamdevice/streamdevice.cpp stream.cpp diagram.cpp
+//     stations.cpp station_data.cpp colors.cpp curves.cpp
+// Then:
+//   ./streamdevice [--save shown.bin] &
+//   python3 tools/stream_frames.py play /dev/pts/N frames.bin
+//   cmp frames.bin shown.bin
+// It stops on Ctrl+C (or SIGTERM) and prints the stream counts.
+//
+// The board takes ~1.2 ms to send a frame to the LEDs, so showing one
+// sleeps that long. Time is real time here, so stream_read() times out
+// packets exactly as the board does.
+
+#include <stdio.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <chrono>
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+#include "diagram.h"
+#include "stream.h"
+#include "stations.h"
+
+#define SHOW_TIME 1200 // us
+
+unsigned long hostMillis = 0;
+HostSerial Serial;
+
+void randomSeed(unsigned long) {}
+long random(long) { return 0; }
+long random(long howSmall, long) { return howSmall; }
+
+static volatile sig_atomic_t stopping = 0;
+
+static void stop(int) {
+  stopping = 1;
+}
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char **argv) {
+  const char *savePath = NULL;
+  if (argc == 3 && strcmp(argv[1], "--save") == 0) {
+    savePath = argv[2];
+  } else if (argc != 1) {
+    fprintf(stderr, "Usage: %s [--save FILE]\n", argv[0]);
+    return 2;
+  }
+  FILE *save = NULL;
+  if (savePath != NULL && (save = fopen(savePath, "wb")) == NULL) {
+    fprintf(stderr, "Could not write %s\n", savePath);
+    return 2;
+  }
+
+  int pty = posix_openpt(O_RDWR | O_NOCTTY);
+  if (pty < 0 || grantpt(pty) != 0 || unlockpt(pty) != 0) {
+    perror("pty");
+    return 2;
+  }
+  struct termios attrs;
+  tcgetattr(pty, &attrs);
+  cfmakeraw(&attrs);
+  tcsetattr(pty, TCSANOW, &attrs);
+  printf("%s\n", ptsname(pty));
+  fflush(stdout);
+  Serial.input = Serial.output = pty;
+  signal(SIGINT, stop);
+  signal(SIGTERM, stop);
+
+  Adafruit_NeoPixel strip(NUM_STATIONS, 6, NEO_GRB + NEO_KHZ800);
+  LineDiagram diagram(&strip);
+  diagram.setBrightness(70);
+  StreamDecoder decoder;
+  memset(&decoder, 0, sizeof(decoder));
+  unsigned long commands = 0;
+  Clock::time_point start = Clock::now();
+
+  while (!stopping) {
+    // As the sketch's streamFrames(): a byte at a time, stopping to show a
+    // frame as soon as one is complete
+    struct pollfd fd = {pty, POLLIN, 0};
+    poll(&fd, 1, 1);
+    hostMillis = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+    while (Serial.available() > 0) {
+      uint8_t value = Serial.read();
+      uint8_t result = stream_read(&decoder, &diagram, value);
+      if (result == STREAM_COMMAND) {
+        commands++;
+      } else if (result == STREAM_FRAME) {
+        diagram.commit();
+        usleep(SHOW_TIME);
+        if (save != NULL) fwrite(decoder.pixels, 1, sizeof(decoder.pixels), save);
+        break;
+      }
+    }
+    stream_update(&decoder, &diagram);
+  }
+
+  if (save != NULL) fclose(save);
+  printf("Shown %lu, bad %u, busy %u, other bytes %lu, strip updates %lu\n",
+         streamStats.shown, streamStats.bad, streamStats.busy, commands, strip.shows);
+  return 0;
+}
@@ -0,0 +1,227 @@
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include "trains.h"
+#include "diagram.h"
+#include "stations.h"
+#include "utils.h"
+
+#define EVENT_DISPATCH 0 // A service sends out its next train
+#define EVENT_DEPART   1 // A train leaves its station
+#define EVENT_ARRIVE   2 // A train reaches the next station
+
+// Times, in ticks
+#define RUN_TIME     75  // Between stations (600 ms)
+#define DWELL_TIME   50  // At a station (400 ms)
+#define LAYOVER_TIME 250 // At the far terminus before heading back (2 s)
+
+typedef struct Service {
+  station_t from;
+  station_t to;
+  uint16_t headway; // Ticks
+} Service;
+
+// Each service is shown in the colour of its first terminus.
+const Service SERVICES[SIM_SERVICES] PROGMEM = {
+  {STN_WATERFRONT, STN_KING_GEORGE, 750},  // Expo Line, every 6 s
+  {STN_WATERFRONT, STN_PRODUCTION, 1500},  // Expo Line, every 12 s
+  {STN_VCC_CLARK, STN_LAFARGE, 1000}       // Millennium Line, every 8 s
+};
+
+static station_t serviceStation(uint8_t service, bool to) {
+  const station_t *stn = to ? &SERVICES[service].to : &SERVICES[service].from;
+  if (sizeof(station_t) == 1) return pgm_read_byte(stn);
+  return pgm_read_word(stn);
+}
+
+static uint16_t serviceHeadway(uint8_t service) {
+  return pgm_read_word(&SERVICES[service].headway);
+}
+
+// The event queue is a binary min-heap on time. Times wrap, so they are
+// compared by their signed difference.
+static bool before(const TrainEvent *a, const TrainEvent *b) {
+  return (int16_t) (a->time - b->time) < 0;
+}
+
+static void swapEvents(TrainEvent *a, TrainEvent *b) {
+  TrainEvent swap = *a;
+  *a = *b;
+  *b = swap;
+}
+
+static void schedule(TrainSim *sim, uint16_t time, uint8_t type, uint8_t subject) {
+  uint8_t i = sim->eventCount++;
+  sim->events[i].time = time;
+  sim->events[i].what = type << SIM_SUBJECT_BITS | subject;
+  while (i > 0) {
+    uint8_t parent = (i - 1) >> 1;
+    if (!before(&sim->events[i], &sim->events[parent])) break;
+    swapEvents(&sim->events[i], &sim->events[parent]);
+    i = parent;
+  }
+}
+
+static TrainEvent nextEvent(TrainSim *sim) {
+  TrainEvent event = sim->events[0];
+  sim->events[0] = sim->events[--sim->eventCount];
+  uint8_t i = 0;
+  while (true) {
+    uint8_t child = 2 * i + 1;
+    if (child >= sim->eventCount) break;
+    if (child + 1 < sim->eventCount && before(&sim->events[child + 1], &sim->events[child])) child++;
+    if (!before(&sim->events[child], &sim->events[i])) break;
+    swapEvents(&sim->events[i], &sim->events[child]);
+    i = child;
+  }
+  return event;
+}
+
+#define STOPPED     0x01
+#define APPROACHING 0x10
+
+// Shows the trains at a station: full colour if one is stopped there,
+// dimmed if one is on its way in.
+static void drawStation(TrainSim *sim, LineDiagram *diagram, station_t stn) {
+  uint8_t occupancy = sim->occupancy[stn];
+  uint8_t services = sim->services[stn];
+  uint32_t color = 0;
+  if (occupancy & 0x0F) {
+    color = stationColor(serviceStation(services & 0x0F, false));
+  } else if (occupancy != 0) {
+    color = (stationColor(serviceStation(services >> 4, false)) >> 2) & 0x3F3F3F;
+  }
+  diagram->set(stn, color);
+}
+
+// A train of the service starts stopping at (STOPPED) or heading to
+// (APPROACHING) the station.
+static void enterStation(TrainSim *sim, station_t stn, uint8_t how, uint8_t service) {
+  sim->occupancy[stn] += how;
+  uint8_t *services = &sim->services[stn];
+  if (how == STOPPED) *services = (*services & 0xF0) | service;
+  else *services = (*services & 0x0F) | (service << 4);
+}
+
+static void leaveStation(TrainSim *sim, station_t stn, uint8_t how) {
+  sim->occupancy[stn] -= how;
+}
+
+static void dispatch(TrainSim *sim, LineDiagram *diagram, uint8_t service, uint16_t now) {
+  schedule(sim, now + serviceHeadway(service), EVENT_DISPATCH, service);
+  // If every train is in service, this one is cancelled
+  if (sim->freeTrain == SIM_NO_TRAIN) return;
+  uint8_t i = sim->freeTrain;
+  Train *train = &sim->trains[i];
+  sim->freeTrain = train->station;
+  train->service = service;
+  train->station = serviceStation(service, false);
+  train->previous = NO_STATION;
+  enterStation(sim, train->station, STOPPED, service);
+  drawStation(sim, diagram, train->station);
+  schedule(sim, now + DWELL_TIME, EVENT_DEPART, i);
+}
+
+static void depart(TrainSim *sim, LineDiagram *diagram, uint8_t i, uint16_t now) {
+  Train *train = &sim->trains[i];
+  station_t next = stationsNext(sim->routes[train->service], train->station, train->previous);
+  leaveStation(sim, train->station, STOPPED);
+  enterStation(sim, next, APPROACHING, train->service);
+  train->previous = train->station;
+  train->station = next;
+  drawStation(sim, diagram, train->previous);
+  drawStation(sim, diagram, next);
+  schedule(sim, now + RUN_TIME, EVENT_ARRIVE, i);
+}
+
+static void arrive(TrainSim *sim, LineDiagram *diagram, uint8_t i, uint16_t now) {
+  Train *train = &sim->trains[i];
+  leaveStation(sim, train->station, APPROACHING);
+  if (stationsNext(sim->routes[train->service], train->station, train->previous) != NO_STATION) {
+    enterStation(sim, train->station, STOPPED, train->service);
+    schedule(sim, now + DWELL_TIME, EVENT_DEPART, i);
+  } else if (train->station == serviceStation(train->service, true)) {
+    // Turn back
+    train->previous = NO_STATION;
+    enterStation(sim, train->station, STOPPED, train->service);
+    schedule(sim, now + LAYOVER_TIME, EVENT_DEPART, i);
+  } else {
+    drawStation(sim, diagram, train->station);
+    train->service = SIM_NO_SERVICE;
+    train->station = sim->freeTrain;
+    sim->freeTrain = i;
+    return;
+  }
+  drawStation(sim, diagram, train->station);
+}
+
+void trains_begin(TrainSim *sim) {
+  for (uint8_t i = 0; i < SIM_SERVICES; i++) {
+    Route route;
+    routeFind(&route, serviceStation(i, false), serviceStation(i, true));
+    memcpy(sim->routes[i], route.stations, sizeof(sim->routes[i]));
+  }
+  // Train 0 is dispatched first
+  for (uint8_t i = 0; i < SIM_TRAINS; i++) {
+    sim->trains[i].service = SIM_NO_SERVICE;
+    sim->trains[i].station = i + 1 < SIM_TRAINS ? i + 1 : SIM_NO_TRAIN;
+  }
+  sim->freeTrain = 0;
+  memset(sim->occupancy, 0, sizeof(sim->occupancy));
+  sim->eventCount = 0;
+  sim->stale = true;
+  // The first trains leave one after another
+  uint16_t now = millis() >> SIM_TICK_SHIFT;
+  for (uint8_t i = 0; i < SIM_SERVICES; i++) {
+    schedule(sim, now + i * DWELL_TIME, EVENT_DISPATCH, i);
+  }
+}
+
+void trains_render(TrainSim *sim, LineDiagram *diagram) {
+  uint16_t now = millis() >> SIM_TICK_SHIFT;
+  if (sim->stale) {
+    sim->stale = false;
+    diagram->clear();
+    for (station_t stn = 0; stn < NUM_STATIONS; stn++) {
+      if (sim->occupancy[stn] != 0) drawStation(sim, diagram, stn);
+    }
+  }
+
+  for (uint8_t handled = 0; handled < SIM_EVENTS_PER_FRAME && sim->eventCount > 0; handled++) {
+    if ((int16_t) (sim->events[0].time - now) > 0) break;
+    TrainEvent event = nextEvent(sim);
+    // Follow-up events are timed from when this one was due, so a backlog
+    // doesn't slow the service down.
+    uint8_t subject = event.what & SIM_SUBJECT_MASK;
+    switch (event.what >> SIM_SUBJECT_BITS) {
+      case EVENT_DISPATCH:
+        dispatch(sim, diagram, subject, event.time);
+        break;
+      case EVENT_DEPART:
+        depart(sim, diagram, subject, event.time);
+        break;
+      case EVENT_ARRIVE:
+        arrive(sim, diagram, subject, event.time);
+        break;
+    }
+  }
+}
+
+void trains_resume(TrainSim *sim) {
+  sim->stale = true;
+  // Events that fell due while something else was shown are moved on, so
+  // the next one is due now.
+  if (sim->eventCount == 0) return;
+  int16_t late = (uint16_t) (millis() >> SIM_TICK_SHIFT) - sim->events[0].time;
+  if (late <= 0) return;
+  for (uint8_t i = 0; i < sim->eventCount; i++) sim->events[i].time += late;
+}
+
+bool trains_wake(const TrainSim *sim, unsigned long *time) {
+  if (sim->eventCount == 0) return false;
+  unsigned long ms = millis();
+  // Events are due at the start of their tick
+  int16_t ticks = sim->events[0].time - (uint16_t) (ms >> SIM_TICK_SHIFT);
+  if (ticks <= 0) *time = ms;
+  else *time = (ms & ~((1UL << SIM_TICK_SHIFT) - 1)) + ((unsigned long) ticks << SIM_TICK_SHIFT);
+  return true;
+}
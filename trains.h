@@ -0,0 +1,88 @@
+// Service simulation (Mode 3, submode 1).
+// Trains run the Expo Line (to King George and to Production Way) and the
+// Millennium Line, each dispatched from its first terminus at a fixed
+// headway. A train dwells at every station, turns back at the far terminus
+// and leaves service when it is back where it started.
+//
+// The simulation is driven by a timed event queue (a binary heap) rather than
+// by looking at every train each frame: every train, and every service's
+// next dispatch, has exactly one pending event. A frame only handles the
+// events that are due, at most SIM_EVENTS_PER_FRAME of them, and only
+// redraws the stations those events touched. Apart from the heap (log of
+// the number of trains), an event costs the same however many trains there
+// are: stations keep count of the trains at and heading to them, so drawing
+// one doesn't look through the trains, and trains out of service are kept
+// on a free list for dispatching. Times are in ticks of 8 ms, kept in 16
+// bits (wrapping every ~9 minutes, which is fine as no event is
+// ever more than a few seconds away).
+//
+// The state shares the modes' memory (see modes.h), so it is kept small:
+// services keep only the stations they call at, events are 3 bytes, and
+// the free list is chained through the trains themselves.
+
+#ifndef _MKIII_TRAINS_H
+#define _MKIII_TRAINS_H
+
+#include <stdint.h>
+#include "diagram.h"
+#include "stations.h"
+
+#define SIM_SERVICES 3
+#define SIM_TRAINS   16
+#define SIM_EVENTS   (SIM_TRAINS + SIM_SERVICES)
+#define SIM_EVENTS_PER_FRAME 8
+
+#define SIM_TICK_SHIFT 3 // 8 ms ticks
+#define SIM_NO_SERVICE 0xFF
+#define SIM_NO_TRAIN   0xFF
+
+// An event's subject shares a byte with its type
+#define SIM_SUBJECT_BITS 6
+#define SIM_SUBJECT_MASK ((1 << SIM_SUBJECT_BITS) - 1)
+#if SIM_TRAINS > SIM_SUBJECT_MASK || SIM_SERVICES > SIM_SUBJECT_MASK
+#error "Too many trains or services for an event's subject"
+#endif
+
+typedef struct TrainEvent {
+  uint16_t time;
+  uint8_t what; // Type << SIM_SUBJECT_BITS | train, or service for a dispatch
+} TrainEvent;
+
+typedef struct Train {
+  // Where the train is, or is heading to while moving. Out of service, the
+  // next free train (SIM_NO_TRAIN at the end of the list).
+  station_t station;
+  station_t previous; // The station before it, NO_STATION at a terminus
+  uint8_t service; // SIM_NO_SERVICE when not in service
+} Train;
+
+typedef struct TrainSim {
+  // The stations on each service's route, a bitset (its termini are in
+  // flash with the rest of the service)
+  uint8_t routes[SIM_SERVICES][BITSET_BYTES(NUM_STATIONS)];
+  Train trains[SIM_TRAINS];
+  TrainEvent events[SIM_EVENTS];
+  // For each station, the number of trains stopped there (low nibble) and
+  // heading there (high nibble). A service's trains are a headway apart each
+  // way, so there are at most two of each service.
+  uint8_t occupancy[NUM_STATIONS];
+  // The service of the last train to stop there (low nibble) and to head
+  // there (high nibble), which gives the station its colour.
+  uint8_t services[NUM_STATIONS];
+  // The first train that is out of service
+  uint8_t freeTrain;
+  uint8_t eventCount;
+  // Everything must be drawn again on the next frame
+  bool stale;
+} TrainSim;
+
+void trains_begin(TrainSim *sim);
+void trains_render(TrainSim *sim, LineDiagram *diagram);
+// Call when the simulation is shown again after something else was. It
+// carries on from where it stopped, as if no time had passed since.
+void trains_resume(TrainSim *sim);
+// Sets *time to the millis() at which the next event is due. Returns false
+// if there is none.
+bool trains_wake(const TrainSim *sim, unsigned long *time);
+
+#endif
@@ -11,6 +11,21 @@ inline uint32_t gamma32(uint32_t x) {
   return Adafruit_NeoPixel::gamma32(x);
 }
 
+// Bitsets, packed 8 entries per byte.
+#define BITSET_BYTES(n) (((n) + 7) / 8)
+
+inline bool bitsetGet(const uint8_t *bits, uint16_t i) {
+  return (bits[i >> 3] >> (i & 7)) & 1;
+}
+
+inline void bitsetSet(uint8_t *bits, uint16_t i) {
+  bits[i >> 3] |= 1 << (i & 7);
+}
+
+inline void bitsetClear(uint8_t *bits, uint16_t i) {
+  bits[i >> 3] &= ~(1 << (i & 7));
+}
+
 const uint32_t c_stn_green = rgb32(0, 127, 0);
 const uint32_t c_stn_red = rgb32(127, 0, 0);
 const uint32_t c_stn_yellow = rgb32(252, 208, 6);
@@ -18,8 +33,6 @@ const uint32_t c_stn_purple = rgb32(113, 30, 139);
 const uint32_t c_stn_orange = rgb32(243, 103, 23);
 const uint32_t c_stn_blue = rgb32(30, 89, 174);
 
-const uint32_t c_expo = rgb32(30, 89, 174);
-const uint32_t c_mill = rgb32(252, 208, 6);
 const uint32_t c_bline = rgb32(243, 103, 23);
 const uint32_t c_wce = rgb32(113, 30, 139);
 const uint32_t c_cl = rgb32(0, 152, 201);